@@ -0,0 +1,65 @@
+/*
+   Alarm levels from the sensor's sampling path. MHZ19Alarm is attached to
+   the sensor, so every valid reading from getCO2() (or receive()) is checked
+   without extra code, and onChange() is called only when the level changes.
+
+   Level 1 (1000ppm) is taken immediately and left below 950ppm. Level 2
+   (1400ppm) must hold for a minute before it is taken or left, so a reading
+   wandering either side of it causes no alarm traffic.
+
+   *Note: with setFilter(true) warm-up readings are rejected by getCO2() and
+   never reach the alarm.
+*/
+
+#include <Arduino.h>
+#include "MHZ19.h"
+#include "MHZ19Alarm.h"
+
+#define RX_PIN 10
+#define TX_PIN 11
+#define BAUDRATE 9600                                      // Native to the sensor (do not change)
+
+MHZ19 myMHZ19;
+MHZ19Alarm myAlarm;
+#if defined(ESP32)
+HardwareSerial mySerial(2);                                // On ESP32 we do not require the SoftwareSerial library, since we have 2 USARTS available
+#else
+#include <SoftwareSerial.h>                                //  Remove if using HardwareSerial or non-uno compatible device
+SoftwareSerial mySerial(RX_PIN, TX_PIN);                   // (Uno example) create device to MH-Z19 serial
+#endif
+
+unsigned long getDataTimer = 0;
+
+void alarmChanged(MHZ19Alarm &alarm, byte level, byte previous, int ppm)
+{
+    Serial.print(level > previous ? "Alarm raised to level " : "Alarm lowered to level ");
+    Serial.print(level);
+    Serial.print(" at CO2 (ppm): ");
+    Serial.println(ppm);
+}
+
+void setup()
+{
+    Serial.begin(9600);
+
+    mySerial.begin(BAUDRATE);                               // (Uno example) device to MH-Z19 serial start
+    myMHZ19.begin(mySerial);                                // *Serial(Stream) reference must be passed to library begin().
+
+    myMHZ19.autoCalibration(false);
+    myMHZ19.setFilter(true, true);                          // Warm-up readings are errors, not samples
+
+    myAlarm.addLevel(1000, 50);                             // Ventilate
+    myAlarm.addLevel(1400, 50, 60000);                      // Poor, held for a minute
+    myAlarm.onChange(alarmChanged);
+    myAlarm.attach(myMHZ19);
+}
+
+void loop()
+{
+    if (millis() - getDataTimer >= 2000)
+    {
+        myMHZ19.getCO2();                                   // The alarm sees the reading, nothing printed unless it changes level
+
+        getDataTimer = millis();
+    }
+}
@@ -1,48 +1,88 @@
 /*
    *Note: This is specific to the range you choose.
-   *Note: Below example will not be accurate.
+   *Note: The default line (y = 6.4995x - 590.53) will not be accurate for your sensor.
 
    The analog output is located on the brown wire on the JST
    version. On the non-JST version it can be found on the far
    side, beside the Rx pin.
 
-   Step 1: Record CO2 ppm and analog values at frequent intervals over your MHZ19 range (i.e. 2000 is default)
-   Step 2: Generated an equation based upon the trend (I.e. y=mx+c (linear), log etc)
-   Step 3: Replace analog reading with x within the equation.
-*/
+   The ADC is oversampled (4^bits samples per value, each bit adding one bit
+   of resolution) in the background with update(), which never blocks.
 
-/*MHZ19 Library not Required*/
+   With CALIBRATE set to 1 (UART connected), the ADC to ppm line is fitted
+   continuously against getCO2() by least squares. Once fitted, print the
+   slope & offset, and pass them to setLine() so the analog path can be used
+   alone with CALIBRATE set to 0.
+*/
 
 #include <Arduino.h>
+#include "MHZ19.h"
+#include "MHZ19Analog.h"
 
 #define ANALOGPIN A0                                          // ADC pin which the brown wire is attached to
+#define OVERSAMPLE_BITS 2                                     // 16 samples per value, 12 bit result
+#define SAMPLE_INTERVAL 1000                                  // Time between ADC samples (us)
+
+#define CALIBRATE 1                                           // <--- set to 0 to use the analog output alone
+
+#define RX_PIN 10
+#define TX_PIN 11
+#define BAUDRATE 9600                                         // Native to the sensor (do not change)
+
+MHZ19Analog myAnalog;
+
+#if CALIBRATE
+MHZ19 myMHZ19;
+#if defined(ESP32)
+HardwareSerial mySerial(2);                                   // On ESP32 we do not require the SoftwareSerial library, since we have 2 USARTS available
+#else
+#include <SoftwareSerial.h>                                   //  Remove if using HardwareSerial or non-uno compatible device
+SoftwareSerial mySerial(RX_PIN, TX_PIN);                      // (Uno example) create device to MH-Z19 serial
+#endif
+#endif
 
 unsigned long myMHZ19Timer = 0;
 
 void setup()
 {
     Serial.begin(9600);
-    pinMode(ANALOGPIN, INPUT_PULLUP);                         // Pullup A0
+
+    myAnalog.begin(ANALOGPIN, OVERSAMPLE_BITS, SAMPLE_INTERVAL);
+    // myAnalog.setLine(slope, offset);                       // <--- your stored fit, when not calibrating
+
+#if CALIBRATE
+    mySerial.begin(BAUDRATE);                                 // (Uno example) device to MH-Z19 serial start
+    myMHZ19.begin(mySerial);                                  // *Serial(Stream) reference must be passed to library begin().
+#endif
 
     Serial.print("\nUsing Pin: ");                            // Print Raw Pin Number
     Serial.println(ANALOGPIN);
-
 }
 
 void loop()
 {
+    myAnalog.update();                                        // Take an ADC sample when due (call often)
+
     if (millis() - myMHZ19Timer >= 2000)
     {
         Serial.println("-----------------");
 
-        float adjustedADC = analogRead(A0);
-        Serial.print("Analog raw: ");
-        Serial.println(adjustedADC);
+        Serial.print("Analog (oversampled): ");
+        Serial.println(myAnalog.getADC());
 
-        adjustedADC = 6.4995*adjustedADC - 590.53; // format; y=mx+c
         Serial.print("Analog CO2: ");
-        Serial.println(adjustedADC);
+        Serial.println(myAnalog.getCO2());
 
+#if CALIBRATE
+        if (myAnalog.calibrate(myMHZ19))                      // Requests CO2 over UART and refits the line
+        {
+            Serial.print("Fitted line, slope (Q16): ");
+            Serial.print(myAnalog.getSlope());
+            Serial.print(" offset: ");
+            Serial.print(myAnalog.getOffset());
+            Serial.println(myAnalog.isCalibrated() ? "" : " (not enough pairs yet)");
+        }
+#endif
         myMHZ19Timer = millis();
     }
 }
@@ -24,6 +24,11 @@
 
 /* final note, I've found it's best to calibrate in this order: setRange(2000) -> calibrate() -> zeroSpan(2000) */
 
+/* Range and ABC already held are skipped. To skip them on later boots without reading back, save
+   the configuration from getConfig() (e.g. to EEPROM) and restore it with setConfig() before calling
+   the set functions, or pass the wanted configuration to applyConfig(), which only writes the fields
+   that differ. Span is a calibration against the gas present, so zeroSpan() is always sent. */
+
 #define EXAMPLE_HAS_RANGE 1  // include range example
 #define EXAMPLE_HAS_SPAN 0   // include span example
 
@@ -51,6 +56,9 @@ void setup()
     mySerial.begin(BAUDRATE);  // Serial for the sensor
     myMHZ19.begin(mySerial);   // Pass it to the library
 
+    myMHZ19.loadConfig();      // Read range & ABC status once, set functions below then skip values already held
+                               // (avoids needless writes to the sensor's memory on every boot)
+
     myMHZ19.autoCalibration(false);   // make sure auto calibration is off for this example
     Serial.print("ABC Status: "); myMHZ19.getABC() ? Serial.println("ON") :  Serial.println("OFF");  // now print it's status
 
@@ -0,0 +1,69 @@
+/*
+   Report by exception. The sensor is read every 2 seconds, but a field is
+   printed (or sent over the radio / MQTT) only when it moves more than its
+   deadband from the value last sent, or every 5 minutes as a heartbeat.
+
+   CO2 is sent on moving more than 20ppm or 3%, temperature on 0.5C. In a
+   steady room this is a few messages an hour instead of 1800.
+
+   *Note: temperature comes from the same reply as CO2, so reading it costs
+   no extra request.
+*/
+
+#include <Arduino.h>
+#include "MHZ19.h"
+#include "MHZ19Deadband.h"
+
+#define RX_PIN 10
+#define TX_PIN 11
+#define BAUDRATE 9600                                      // Native to the sensor (do not change)
+
+MHZ19 myMHZ19;
+MHZ19Deadband myDeadband;
+#if defined(ESP32)
+HardwareSerial mySerial(2);                                // On ESP32 we do not require the SoftwareSerial library, since we have 2 USARTS available
+#else
+#include <SoftwareSerial.h>                                //  Remove if using HardwareSerial or non-uno compatible device
+SoftwareSerial mySerial(RX_PIN, TX_PIN);                   // (Uno example) create device to MH-Z19 serial
+#endif
+
+unsigned long getDataTimer = 0;
+
+void setup()
+{
+    Serial.begin(9600);
+
+    mySerial.begin(BAUDRATE);                               // (Uno example) device to MH-Z19 serial start
+    myMHZ19.begin(mySerial);                                // *Serial(Stream) reference must be passed to library begin().
+
+    myMHZ19.autoCalibration(false);
+    myMHZ19.setFilter(true, true);                          // Warm-up readings are errors, never sent
+
+    myDeadband.setDeadband(DEADBAND_CO2, 20, 3);            // 20ppm or 3%, whichever is larger
+    myDeadband.setDeadband(DEADBAND_TEMPERATURE, 50);       // 0.5C (centi-degrees)
+    myDeadband.setHeartbeat(300000);                        // At least every 5 minutes
+}
+
+void loop()
+{
+    if (millis() - getDataTimer >= 2000)
+    {
+        getDataTimer = millis();
+
+        myMHZ19.getCO2();
+
+        byte publish = myDeadband.update(myMHZ19);          // Uses the reply just received, no extra request
+
+        if (publish & MHZ19_DEADBAND_BIT(DEADBAND_CO2))
+        {
+            Serial.print("co2=");
+            Serial.println(myDeadband.getPublished(DEADBAND_CO2));
+        }
+
+        if (publish & MHZ19_DEADBAND_BIT(DEADBAND_TEMPERATURE))
+        {
+            Serial.print("temperature=");
+            Serial.println(myDeadband.getPublished(DEADBAND_TEMPERATURE) / 100.0);
+        }
+    }
+}
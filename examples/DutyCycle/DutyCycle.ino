@@ -0,0 +1,71 @@
+/*
+   A battery node can sleep until the library next needs the CPU.
+   nextDeadline() / untilDeadline() cover an awaited reply, the sample period
+   and maintenance such as the 12 hour ABC OFF resend. On waking, sampleDue()
+   runs any due maintenance and says whether to take a sample.
+
+   Here a sample is taken each minute. The wait for the reply (about 40ms)
+   is spent awake, since the UART does not receive during light sleep, so the
+   node sleeps about 60 times an hour instead of polling.
+
+   *Note: ESP32 light sleep keeps millis() running. Where a sleep mode stops
+   millis(), give the library a clock which keeps counting (e.g. from an RTC)
+   with setClock() before begin().
+*/
+
+#include <Arduino.h>
+#include "MHZ19.h"
+
+#define RX_PIN 10
+#define TX_PIN 11
+#define BAUDRATE 9600                                      // Native to the sensor (do not change)
+
+MHZ19 myMHZ19;
+#if defined(ESP32)
+HardwareSerial mySerial(2);                                // On ESP32 we do not require the SoftwareSerial library, since we have 2 USARTS available
+#else
+#include <SoftwareSerial.h>                                //  Remove if using HardwareSerial or non-uno compatible device
+SoftwareSerial mySerial(RX_PIN, TX_PIN);                   // (Uno example) create device to MH-Z19 serial
+#endif
+
+void sleepFor(unsigned long ms)
+{
+#if defined(ESP32)
+    Serial.flush();
+    esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000);
+    esp_light_sleep_start();
+#else
+    delay(ms);                                              // Replace with the board's sleep, woken by a timer
+#endif
+}
+
+void setup()
+{
+    Serial.begin(9600);
+
+    mySerial.begin(BAUDRATE);                               // (Uno example) device to MH-Z19 serial start
+    myMHZ19.begin(mySerial);                                // *Serial(Stream) reference must be passed to library begin().
+
+    myMHZ19.autoCalibration(false);                         // ABC OFF is resent every 12 hours, within the deadlines
+    myMHZ19.autoMaintenance(false);                         // Maintenance runs from sampleDue() instead
+    myMHZ19.setSamplePeriod(60000);                         // sampleDue() every minute
+}
+
+void loop()
+{
+    if (myMHZ19.isPending())
+        delay(myMHZ19.untilDeadline());                     // Awake, the reply is on its way
+    else
+        sleepFor(myMHZ19.untilDeadline());
+
+    if (myMHZ19.isPending())
+    {
+        if (myMHZ19.receive() && myMHZ19.errorCode == RESULT_OK)
+        {
+            Serial.print("CO2 (ppm): ");
+            Serial.println(myMHZ19.getCO2(true, false));    // false: the reply just received
+        }
+    }
+    else if (myMHZ19.sampleDue())
+        myMHZ19.requestCO2();                               // Reply is collected on the next pass
+}
@@ -13,6 +13,11 @@
 	RESULT_CRC = 4,              // Received data does not match the CRC given
     RESULT_FILTER = 5,           // Filter was triggered (see FilterUsage example)
 	RESULT_FAILED = 6            // Not currently used
+
+   Additionally, with MHZ19_ERRORS enabled (default), each fault is recorded
+   as a compact event (code, argument and time) in a small ring buffer rather
+   than being printed as it happens. Drain the ring with getEvent() whenever it
+   suits your program, and use printEvent() to turn an event into text.
 */
 
 #include <Arduino.h>
@@ -67,6 +72,10 @@ void loop()
             Serial.println(myMHZ19.errorCode);          // Get the Error Code value
         }
 
+        MHZ19Event event;
+        while (myMHZ19.getEvent(event))                 // Drain any recorded error events
+            myMHZ19.printEvent(Serial, event);          // Text is stored in flash, not RAM
+
         getDataTimer = millis();
     }
 }
@@ -0,0 +1,69 @@
+/*
+   begin() verifies communication (2 requests) and reads the firmware
+   version (1 request) before the first reading. For nodes which wake from
+   deep sleep or power down often, save the identity once and pass it to
+   begin() on later boots: begin() then returns at once, and the first real
+   request confirms communication instead (see isVerified()).
+
+   The identity is kept in RTC memory on ESP32 (survives deep sleep) and in
+   EEPROM elsewhere. Clear it (or change IDENTITY_ADDRESS) if the sensor is
+   replaced.
+*/
+
+#include <Arduino.h>
+#include "MHZ19.h"
+
+#define RX_PIN 10
+#define TX_PIN 11
+#define BAUDRATE 9600                                      // Native to the sensor (do not change)
+#define IDENTITY_ADDRESS 0                                 // EEPROM address of the saved identity
+
+MHZ19 myMHZ19;
+#if defined(ESP32)
+HardwareSerial mySerial(2);                                // On ESP32 we do not require the SoftwareSerial library, since we have 2 USARTS available
+RTC_DATA_ATTR MHZ19Identity savedIdentity;                 // Kept through deep sleep
+#else
+#include <EEPROM.h>
+#include <SoftwareSerial.h>                                //  Remove if using HardwareSerial or non-uno compatible device
+SoftwareSerial mySerial(RX_PIN, TX_PIN);                   // (Uno example) create device to MH-Z19 serial
+MHZ19Identity savedIdentity;
+#endif
+
+void setup()
+{
+    Serial.begin(9600);
+    mySerial.begin(BAUDRATE);                               // (Uno example) device to MH-Z19 serial start
+
+#if !defined(ESP32)
+    EEPROM.get(IDENTITY_ADDRESS, savedIdentity);            // Invalid (e.g. blank) identities are detected
+#endif
+
+    unsigned long start = millis();
+    myMHZ19.begin(mySerial, savedIdentity);                 // Returns immediately with a valid identity
+
+    int CO2 = myMHZ19.getCO2();                             // First request also verifies communication
+    unsigned long took = millis() - start;
+
+    Serial.print("CO2 (ppm): ");
+    Serial.print(CO2);
+    Serial.print("   Wake to first sample (ms): ");
+    Serial.println(took);
+
+    MHZ19Identity identity;
+    if (myMHZ19.isVerified() && myMHZ19.getIdentity(identity) && memcmp(&identity, &savedIdentity, sizeof(identity)))
+    {
+        savedIdentity = identity;                           // Only written when it changed
+#if !defined(ESP32)
+        EEPROM.put(IDENTITY_ADDRESS, savedIdentity);
+#endif
+        Serial.println("Identity saved for the next boot.");
+    }
+
+#if defined(ESP32)
+    esp_deep_sleep(10 * 1000000ULL);                        // Sleep 10s, then start again from setup()
+#endif
+}
+
+void loop()
+{
+}
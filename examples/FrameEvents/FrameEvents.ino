@@ -0,0 +1,76 @@
+/*
+   Requests can be sent without waiting for the reply. The reply is parsed as
+   its bytes arrive by receive(), and the function given to onFrame() is called
+   once a whole frame has been checked (or the request timed out).
+
+   On ESP32, receive() is run by the UART receive event, so nothing is spent
+   on the sensor until bytes are actually there. Elsewhere receive() is simply
+   called from loop(), it returns straight away while no bytes are waiting.
+
+   *Note: On ESP32 the receive event (and so onFrame()) runs in the UART
+   event task, not in loop(). Keep the callback short, and do not call
+   blocking functions (getCO2() with force, setRange() etc.) from it.
+   receive() is also called from loop() so a missing reply times out. The
+   two never parse at once, whichever finds the receiver busy returns false.
+*/
+
+#include <Arduino.h>
+#include "MHZ19.h"
+
+#define RX_PIN 10
+#define TX_PIN 11
+#define BAUDRATE 9600                                      // Native to the sensor (do not change)
+
+MHZ19 myMHZ19;
+#if defined(ESP32)
+HardwareSerial mySerial(2);                                // On ESP32 we do not require the SoftwareSerial library, since we have 2 USARTS available
+#else
+#include <SoftwareSerial.h>                                //  Remove if using HardwareSerial or non-uno compatible device
+SoftwareSerial mySerial(RX_PIN, TX_PIN);                   // (Uno example) create device to MH-Z19 serial
+#endif
+
+volatile int CO2 = 0;
+volatile bool fresh = false;
+unsigned long getDataTimer = 0;
+
+void onFrame(MHZ19 &sensor, byte command, byte result)
+{
+    if (result == RESULT_OK)
+    {
+        CO2 = sensor.getCO2(true, false);                   // false: read the frame just received, no request
+        fresh = true;
+    }
+}
+
+void setup()
+{
+    Serial.begin(9600);
+
+    mySerial.begin(BAUDRATE);                               // (Uno example) device to MH-Z19 serial start
+    myMHZ19.begin(mySerial);                                // *Serial(Stream) reference must be passed to library begin().
+
+    myMHZ19.onFrame(onFrame);
+
+#if defined(ESP32)
+    mySerial.onReceive([]() { myMHZ19.receive(); });        // Parse bytes as the UART receives them
+#endif
+}
+
+void loop()
+{
+    myMHZ19.receive();                                      // Polls on other boards, catches time outs on ESP32
+
+    if (millis() - getDataTimer >= 2000)
+    {
+        myMHZ19.requestCO2();                               // Returns at once, the reply arrives in onFrame()
+        getDataTimer = millis();
+    }
+
+    if (fresh)
+    {
+        fresh = false;
+
+        Serial.print("CO2 (ppm): ");
+        Serial.println(CO2);
+    }
+}
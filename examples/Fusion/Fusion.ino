@@ -0,0 +1,78 @@
+/*
+   Where several sensors watch the same space, their readings can be fused
+   into one value. Each cycle, sensors which fail to reply or read too far
+   from the median of the group are left out, and the rest are averaged.
+
+   The confidence (0 - 100) drops as sensors are excluded or disagree, and is
+   at most 50 when only one sensor remains.
+
+   *Note: Sensors at different ages (or ABC states) can sit a steady offset
+   apart. Raise the threshold if healthy sensors are regularly excluded.
+*/
+
+#include <Arduino.h>
+#include "MHZ19.h"
+#include "MHZ19Fusion.h"
+
+#define BAUDRATE 9600                                      // Native to the sensor (do not change)
+
+#if defined(ESP32)
+HardwareSerial serialA(1);                                 // ESP32 has 2 free USARTS, one per sensor
+HardwareSerial serialB(2);
+#else
+#include <SoftwareSerial.h>                                //  Remove if using HardwareSerial or non-uno compatible device
+SoftwareSerial serialA(10, 11);                            // (Uno example) only one SoftwareSerial can listen at a time,
+SoftwareSerial serialB(8, 9);                              // listen() is called before each request below
+#endif
+
+MHZ19 sensorA;
+MHZ19 sensorB;
+MHZ19Fusion fusion;
+
+unsigned long getDataTimer = 0;
+
+void setup()
+{
+    Serial.begin(9600);
+
+    serialA.begin(BAUDRATE);
+    serialB.begin(BAUDRATE);
+    sensorA.begin(serialA);
+    sensorB.begin(serialB);
+
+    fusion.add(sensorA);
+    fusion.add(sensorB);
+    fusion.setThreshold(100, 10);                           // Outlier beyond 100ppm or 10% of the median, whichever is larger
+}
+
+void loop()
+{
+    if (millis() - getDataTimer >= 2000)
+    {
+        int ppm[2];
+        byte codes[2];
+
+#if !defined(ESP32)
+        serialA.listen();
+#endif
+        ppm[0] = sensorA.getCO2();
+        codes[0] = sensorA.errorCode;
+
+#if !defined(ESP32)
+        serialB.listen();
+#endif
+        ppm[1] = sensorB.getCO2();
+        codes[1] = sensorB.errorCode;
+
+        int CO2 = fusion.fuse(ppm, codes, 2);               // With hardware serials, fusion.update() does the requests itself
+
+        Serial.print("CO2 (ppm): ");
+        Serial.print(CO2);
+        Serial.print("   Confidence: ");
+        Serial.print(fusion.getConfidence());
+        Serial.print("   Excluded: ");
+        Serial.println(fusion.getExcluded(), BIN);
+
+        getDataTimer = millis();
+    }
+}
@@ -0,0 +1,59 @@
+/*
+   Readings and link health (result counts, recent failures) can be written
+   out for a monitoring stack, as Prometheus text or Influx line protocol.
+   The exporter prints straight to any Print (Serial, a WiFiClient, a file)
+   or fills a fixed buffer, so no String is built and nothing is allocated.
+
+   *Note: With a buffer, only whole lines are kept if it is too small. Size it
+   from the lengths given in MHZ19Export.h, or check the length returned.
+*/
+
+#include <Arduino.h>
+#include "MHZ19.h"
+#include "MHZ19Export.h"
+
+#define RX_PIN 10
+#define TX_PIN 11
+#define BAUDRATE 9600                                      // Native to the sensor (do not change)
+
+MHZ19 myMHZ19;
+#if defined(ESP32)
+HardwareSerial mySerial(2);                                // On ESP32 we do not require the SoftwareSerial library, since we have 2 USARTS available
+#else
+#include <SoftwareSerial.h>                                //  Remove if using HardwareSerial or non-uno compatible device
+SoftwareSerial mySerial(RX_PIN, TX_PIN);                   // (Uno example) create device to MH-Z19 serial
+#endif
+
+MHZ19Export prometheus;
+MHZ19Export influx;
+
+char line[256];                                            // Influx line, at most about 250 characters
+unsigned long getDataTimer = 0;
+
+void setup()
+{
+    Serial.begin(9600);
+
+    mySerial.begin(BAUDRATE);                               // (Uno example) device to MH-Z19 serial start
+    myMHZ19.begin(mySerial);                                // *Serial(Stream) reference must be passed to library begin().
+
+    prometheus.begin(myMHZ19, EXPORT_PROMETHEUS, "office");
+    influx.begin(myMHZ19, EXPORT_INFLUX, "office");
+}
+
+void loop()
+{
+    if (millis() - getDataTimer >= 10000)
+    {
+        prometheus.write(Serial);                           // Fresh readings, printed as they are formatted
+
+        size_t length = influx.write(line, sizeof(line), false);   // false: reuse the readings just taken
+
+        Serial.print("Influx (");
+        Serial.print(length);
+        Serial.print(" chars): ");
+        Serial.print(line);
+
+        getDataTimer = millis();
+    }
+}
@@ -0,0 +1,85 @@
+/*
+   Several sensors can share one serial port through an analog multiplexer.
+   Here 8 sensors sit behind two 74HC4051 (one switching TX, one RX) sharing
+   3 select pins, giving 8 logical devices on one port. update() never
+   blocks: it switches channel, waits for the line to settle, clears stale
+   bytes, requests CO2 and moves on once the reply is in.
+
+   A sweep over 8 sensors takes roughly 250ms. The sensors only refresh
+   their reading every few seconds, so setInterval() spaces sweeps out.
+
+   *Note: Each sensor's automatic maintenance is turned OFF by add(), since
+   it would talk to whichever channel happens to be selected. update() runs
+   it instead, when the sensor's channel comes round. For blocking calls on
+   one sensor (setRange(), autoCalibration() etc.) use select() first.
+*/
+
+#include <Arduino.h>
+#include "MHZ19.h"
+#include "MHZ19Mux.h"
+
+#define RX_PIN 10
+#define TX_PIN 11
+#define BAUDRATE 9600                                      // Native to the sensor (do not change)
+#define SENSORS 8
+
+const byte selectPins[] = { 4, 5, 6 };                     // S0, S1, S2 of the mux
+#define ENABLE_PIN 7                                       // INH pin of both muxes (active low)
+
+MHZ19 sensors[SENSORS];
+MHZ19Mux mux;
+#if defined(ESP32)
+HardwareSerial mySerial(2);                                // On ESP32 we do not require the SoftwareSerial library, since we have 2 USARTS available
+#else
+#include <SoftwareSerial.h>                                //  Remove if using HardwareSerial or non-uno compatible device
+SoftwareSerial mySerial(RX_PIN, TX_PIN);                   // (Uno example) create device to MH-Z19 serial
+#endif
+
+unsigned long reportTimer = 0;
+
+void setup()
+{
+    Serial.begin(9600);
+
+    mySerial.begin(BAUDRATE);                               // (Uno example) device to MH-Z19 serial start
+
+    mux.begin(mySerial, selectPins, 3, ENABLE_PIN);
+    mux.setSettle(1000);                                    // 1ms for the line to settle after switching
+    mux.setInterval(5000);                                  // Start a sweep at most every 5s
+
+    for (byte i = 0; i < SENSORS; i++)
+    {
+        if (mux.add(sensors[i], i) != 0)                    // Selects the channel and runs begin() on it
+        {
+            Serial.print("Sensor on channel ");
+            Serial.print(i);
+            Serial.println(" did not respond");
+        }
+    }
+
+    mux.select(0);                                          // Blocking calls for one sensor, after select()
+    sensors[0].autoCalibration(false);
+}
+
+void loop()
+{
+    int8_t channel = mux.update();                          // Returns the channel whose reply just came in
+
+    if (channel >= 0 && sensors[channel].errorCode == RESULT_OK)
+    {
+        Serial.print("Channel ");
+        Serial.print(channel);
+        Serial.print(" CO2 (ppm): ");
+        Serial.println(sensors[channel].getCO2(true, false));   // false: the reply just collected
+    }
+
+    if (millis() - reportTimer >= 60000)
+    {
+        Serial.print("Sweep time (ms): ");
+        Serial.print(mux.getSweepTime());
+        Serial.print("   Sweeps per hour: ");
+        Serial.println(mux.getSweepRate());
+
+        reportTimer = millis();
+    }
+}
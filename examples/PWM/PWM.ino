@@ -0,0 +1,52 @@
+/*
+   Reads CO2 from the sensor's PWM pin, with no UART traffic.
+
+   Edges are timestamped by an interrupt and ppm is calculated from the high
+   and low times using the datasheet formula, so reading never blocks. The
+   range given to begin() must match the sensor's range (see getRange()).
+
+   Connect the sensor's PWM output to an interrupt capable pin (see the
+   datasheet pinout). Up to 4 sensors can be read at once, each on its
+   own pin.
+*/
+
+#include <Arduino.h>
+#include "MHZ19.h"
+#include "MHZ19PWM.h"
+
+#define PWM_PIN 2                                          // Interrupt capable pin which PWM is attached to
+#define RANGE 2000                                         // Must match the sensor's range
+
+MHZ19PWM myPWM;
+
+unsigned long getDataTimer = 0;
+
+void setup()
+{
+    Serial.begin(9600);
+
+    if (myPWM.begin(PWM_PIN, RANGE))                       // Attach to the pin's interrupt
+        Serial.println("PWM pin has no interrupt available.");
+}
+
+void loop()
+{
+    if (millis() - getDataTimer >= 2000)
+    {
+        if (myPWM.getStatus() == PWM_OK)                   // A cycle has been decoded recently
+        {
+            Serial.print("CO2 (ppm): ");
+            Serial.print(myPWM.getCO2());                  // Latest decoded value (never blocks)
+
+            Serial.print("   Age (ms): ");
+            Serial.println(myPWM.getAge());
+        }
+        else
+        {
+            Serial.print("Waiting for PWM, status: ");
+            Serial.println(myPWM.getStatus());
+        }
+
+        getDataTimer = millis();
+    }
+}
@@ -0,0 +1,79 @@
+/*
+   The sensor's supply is switched through a MOSFET on SUPPLY_PIN and powered
+   only to take a sample. MHZ19Power holds requests back while the sensor
+   boots, then checks the warm-up signature (limited CO2 at 410 while
+   unlimited differs) every 5 seconds, so the sample is taken as soon as the
+   readings are valid rather than after the full 3 minute preheat.
+
+   The powered time per valid sample is printed, the figure to multiply by
+   the sensor's supply current (up to 150mA peak, about 40mA average).
+
+   *Note: begin() the sensor while it is powered (as here), or from a saved
+   identity with no communication. With the supply OFF the RX line should
+   not be driven high into the unpowered sensor, keep series resistors fitted.
+*/
+
+#include <Arduino.h>
+#include "MHZ19.h"
+#include "MHZ19Power.h"
+
+#define RX_PIN 10
+#define TX_PIN 11
+#define BAUDRATE 9600                                      // Native to the sensor (do not change)
+#define SUPPLY_PIN 5                                       // Gate of an N-channel low side MOSFET
+#define SAMPLE_PERIOD 900000UL                             // One sample every 15 minutes
+
+MHZ19 myMHZ19;
+MHZ19Power myPower;
+#if defined(ESP32)
+HardwareSerial mySerial(2);                                // On ESP32 we do not require the SoftwareSerial library, since we have 2 USARTS available
+#else
+#include <SoftwareSerial.h>                                //  Remove if using HardwareSerial or non-uno compatible device
+SoftwareSerial mySerial(RX_PIN, TX_PIN);                   // (Uno example) create device to MH-Z19 serial
+#endif
+
+unsigned long sampleTimer = 0;
+
+void setup()
+{
+    Serial.begin(9600);
+
+    pinMode(SUPPLY_PIN, OUTPUT);
+    digitalWrite(SUPPLY_PIN, HIGH);                         // Powered for begin()
+    delay(MHZ19_POWER_BOOT);
+
+    mySerial.begin(BAUDRATE);                               // (Uno example) device to MH-Z19 serial start
+    myMHZ19.begin(mySerial);                                // *Serial(Stream) reference must be passed to library begin().
+    myMHZ19.autoCalibration(false);
+
+    myPower.begin(myMHZ19, SUPPLY_PIN);                     // Supply OFF until the first sample
+
+    sampleTimer = millis() - SAMPLE_PERIOD;
+}
+
+void loop()
+{
+    if (millis() - sampleTimer >= SAMPLE_PERIOD)
+    {
+        sampleTimer = millis();
+        myPower.on();
+    }
+
+    if (myPower.update() != POWER_READY)
+        return;
+
+    int CO2 = myPower.getCO2();
+
+    if (myMHZ19.errorCode == RESULT_OK)
+    {
+        Serial.print("CO2 (ppm): ");
+        Serial.print(CO2);
+        Serial.print("  ready after (ms): ");
+        Serial.println(myPower.getWarmupTime());
+    }
+
+    myPower.off();
+
+    Serial.print("Powered ms per valid sample: ");
+    Serial.println(myPower.getOnTimePerSample());
+}
@@ -0,0 +1,55 @@
+/*
+   For fixed interval polling, the next CO2 request can be sent as soon as
+   the previous reply is consumed. By the time getCO2() is called again the
+   reply is already waiting in the serial buffer, so the call returns without
+   waiting for the sensor (roughly 10ms saved per reading).
+
+   *Note: The reading returned is from when the request was sent, i.e. the
+   previous call. Use the maxAge argument of setPrefetch() to refresh replies
+   which have waited too long. Any other command in between collects the
+   pending reply first, and the next getCO2() is then a normal request.
+*/
+
+#include <Arduino.h>
+#include "MHZ19.h"
+
+#define RX_PIN 10
+#define TX_PIN 11
+#define BAUDRATE 9600                                      // Native to the sensor (do not change)
+
+MHZ19 myMHZ19;
+#if defined(ESP32)
+HardwareSerial mySerial(2);                                // On ESP32 we do not require the SoftwareSerial library, since we have 2 USARTS available
+#else
+#include <SoftwareSerial.h>                                //  Remove if using HardwareSerial or non-uno compatible device
+SoftwareSerial mySerial(RX_PIN, TX_PIN);                   // (Uno example) create device to MH-Z19 serial
+#endif
+
+unsigned long getDataTimer = 0;
+
+void setup()
+{
+    Serial.begin(9600);
+
+    mySerial.begin(BAUDRATE);                               // (Uno example) device to MH-Z19 serial start
+    myMHZ19.begin(mySerial);                                // *Serial(Stream) reference must be passed to library begin().
+
+    myMHZ19.setPrefetch(true, 5000);                        // Keep a request in flight, refresh replies older than 5s
+}
+
+void loop()
+{
+    if (millis() - getDataTimer >= 2000)
+    {
+        unsigned long start = micros();
+        int CO2 = myMHZ19.getCO2();                         // Served from the reply already received
+        unsigned long took = micros() - start;
+
+        Serial.print("CO2 (ppm): ");
+        Serial.print(CO2);
+        Serial.print("   Call took (us): ");
+        Serial.println(took);
+
+        getDataTimer = millis();
+    }
+}
@@ -0,0 +1,92 @@
+/*
+   Estimates CO2 ppm from the raw (command 132) value using an integer
+   lookup table, without floats. Useful to cross-check the sensor's own
+   algorithm, or on slow nodes which only request the raw value.
+
+   Step 1: Set LOG_PAIRS to 1 and log the printed "raw,ppm" lines over a wide range of CO2.
+   Step 2: Build a table on your PC with extras/Host/RawFit:  ./RawFit -k 16 < log.csv > table.h
+   Step 3: Paste the table below, set LOG_PAIRS to 0 and upload again.
+
+   *Note: The table below was fitted on one sensor and will not be accurate for yours.
+*/
+
+#include <Arduino.h>
+#include "MHZ19.h"
+#include "MHZ19RawModel.h"
+
+#define RX_PIN 10
+#define TX_PIN 11
+#define BAUDRATE 9600                                      // Native to the sensor (do not change)
+
+#define LOG_PAIRS 0                                        // <--- set to 1 to print pairs for RawFit
+
+MHZ19 myMHZ19;
+MHZ19RawModel myModel;
+#if defined(ESP32)
+HardwareSerial mySerial(2);                                // On ESP32 we do not require the SoftwareSerial library, since we have 2 USARTS available
+#else
+#include <SoftwareSerial.h>                                //  Remove if using HardwareSerial or non-uno compatible device
+SoftwareSerial mySerial(RX_PIN, TX_PIN);                   // (Uno example) create device to MH-Z19 serial
+#endif
+
+/* generated by RawFit, sorted by ascending raw */
+const MHZ19RawPoint rawTable[8] PROGMEM = {
+    {30770, 1898},
+    {31573, 1667},
+    {32283, 1467},
+    {33042, 1258},
+    {33768, 1063},
+    {34513, 865},
+    {35245, 677},
+    {35953, 499}
+};
+
+unsigned long getDataTimer = 0;
+
+void setup()
+{
+    Serial.begin(9600);
+
+    mySerial.begin(BAUDRATE);                               // (Uno example) device to MH-Z19 serial start
+    myMHZ19.begin(mySerial);                                // *Serial(Stream) reference must be passed to library begin().
+
+    myModel.begin(rawTable, 8, true);                       // Table is held in flash (PROGMEM)
+}
+
+void loop()
+{
+    if (millis() - getDataTimer >= 2000)
+    {
+        getDataTimer = millis();
+
+        unsigned int raw = myMHZ19.getCO2Raw();             // Request raw value (command 132)
+
+        if (myMHZ19.errorCode != RESULT_OK)                 // A failed request leaves raw meaningless, do not convert it
+        {
+            Serial.print("Raw request failed, error: ");
+            Serial.println(myMHZ19.errorCode);
+            return;
+        }
+
+        int CO2 = myMHZ19.getCO2();                         // Request CO2 as ppm (command 133)
+
+        if (myMHZ19.errorCode != RESULT_OK)
+        {
+            Serial.print("CO2 request failed, error: ");
+            Serial.println(myMHZ19.errorCode);
+            return;
+        }
+
+#if LOG_PAIRS
+        Serial.print(raw);                                  // Line format read by RawFit
+        Serial.print(",");
+        Serial.println(CO2);
+#else
+        Serial.print("CO2 (ppm): ");
+        Serial.print(CO2);
+
+        Serial.print("   Modelled CO2 (ppm): ");
+        Serial.println(myModel.toPPM(raw));                 // Integer interpolation of the raw value
+#endif
+    }
+}
@@ -5,18 +5,26 @@
 
    This sequence goes through a reset sequence and will attempt
    to reset the device if there is an issue. This is repeated until a rational
-   result is given. */
+   result is given.
+
+   MHZ19Recovery watches the readings (errors, out of range or stuck values),
+   resets the sensor, waits for it to boot and re-verifies with increasing
+   gaps between attempts. Only the reset command itself waits for a reply
+   (up to 500ms), so other work carries on, and progress is reported
+   through a callback. */
 
 #define FORCE_SPAN 0                                       // < --- set to 1 as an absolute final resort
 
 #include <Arduino.h>
 #include "MHZ19.h"
+#include "MHZ19Recovery.h"
 
 #define RX_PIN 10
 #define TX_PIN 11
 #define BAUDRATE 9600                                      // Native to the sensor (do not change)
 
 MHZ19 myMHZ19;
+MHZ19Recovery myRecovery;
 #if defined(ESP32)
 HardwareSerial mySerial(2);                                // On ESP32 we do not require the SoftwareSerial library, since we have 2 USARTS available
 #else
@@ -28,12 +36,13 @@ unsigned long getDataTimer = 0;
 
 void setRange(int range);                                  // Declarations for non-IDE platform
 void printErrorCode();
+void printProgress(byte state, byte arg);
 
 void setup()
 {
     Serial.begin(9600);
 
-    Serial.begin(BAUDRATE);                                  // Uno example: Begin Stream with MHZ19 baudrate
+    mySerial.begin(BAUDRATE);                                // Uno example: Begin Stream with MHZ19 baudrate
     myMHZ19.begin(mySerial);                                 // *Important, Pass your Stream reference
 
     setRange(2000);                                          // Set Range 2000
@@ -54,74 +63,64 @@ void setup()
         myMHZ19.autoCalibration(false);                       // Turn auto calibration OFF
     else
         printErrorCode();
+
+    myRecovery.begin(myMHZ19);
+    myRecovery.setLimits(390, 2000);                          // Readings outside this range are suspect
+    myRecovery.setThresholds(10, 20, 60);                     // Consecutive errors / out of range / identical readings
+    myRecovery.setTiming(30000, 1000);                        // Boot wait after reset, first gap between verify attempts
+    myRecovery.onProgress(printProgress);
 }
 
 void loop()
 {
-    static byte timeout = 0;
+    myRecovery.update();                                      // Advances recovery, never waits for the boot
+
+    if (myRecovery.isRecovering())                            // Leave the sensor alone, other work continues
+        return;
 
     if (millis() - getDataTimer >= 2000)
     {
         int CO2;                                        // Buffer for CO2
         CO2 = myMHZ19.getCO2();                         // Request CO2 (as ppm)
 
-        if (CO2 < 390 || CO2 > 2000)
-        {
-            Serial.println("Waiting for verification....");
-
-            timeout++;
-
-            if (timeout > 20)
-            {
-                Serial.println("Failed to verify.");
-                Serial.println("Requesting MHZ19 reset sequence");
-
-                myMHZ19.recoveryReset();                                            // Recovery Reset
-
-                Serial.println("Restarting MHZ19.");
-                Serial.println("Waiting for boot duration to elapse.....");
-
-                delay(30000);
-
-                Serial.println("Waiting for boot verification...");
-
-                for (byte i = 0; i < 3; i++)
-                {
-                    myMHZ19.verify();                                              // verification check
+        myRecovery.sample(CO2);                         // Feed the reading (and errorCode) to the watchdog
 
-                    if (myMHZ19.errorCode == RESULT_OK)
-                        break;
-                }
+        Serial.print("CO2 (ppm): ");
+        Serial.println(CO2);
 
-                if (myMHZ19.errorCode == RESULT_OK)
-                    Serial.println("Verified boot completion, please restart your device.");
+        int8_t Temp;                                    // Buffer for temperature
+        Temp = myMHZ19.getTemperature();
 
-                else
-                    Serial.println("Failed to verify boot completion, check UART connection or increase delay.");
+        Serial.print("Temperature (C): ");
+        Serial.println(Temp);
 
-                while (1 == 1);
-            }
-        }
-
-        else
-        {
-            Serial.println("Verified! Please upload a new sketch to avoid repeat recovery.");
-
-            timeout = 0;                                // Rest Timeout Counter
-
-            Serial.print("CO2 (ppm): ");
-            Serial.println(CO2);
-
-            int8_t Temp;                                 // Buffer for temperature
-            Temp = myMHZ19.getTemperature();
-
-            Serial.print("Temperature (C): ");
-            Serial.println(Temp);
-        }
         getDataTimer = millis();
     }
 }
 
+void printProgress(byte state, byte arg)
+{
+    switch (state)
+    {
+    case RECOVERY_RESET:
+        Serial.print("Requesting MHZ19 reset sequence, reset: ");
+        break;
+    case RECOVERY_WARMUP:
+        Serial.print("Waiting for boot duration to elapse, reset: ");
+        break;
+    case RECOVERY_VERIFY:
+        Serial.print("Waiting for boot verification, attempt: ");
+        break;
+    case RECOVERY_OK:
+        Serial.print("Verified boot completion, attempt: ");
+        break;
+    case RECOVERY_FAILED:
+        Serial.print("Failed to verify boot completion, check UART connection or increase delay. Resets: ");
+        break;
+    }
+    Serial.println(arg);
+}
+
 void setRange(int range)
 {
     Serial.println("Setting range..");
@@ -0,0 +1,94 @@
+/*
+   Buffers readings while offline and sends them as one compressed batch.
+   MHZ19Series packs each (timestamp, ppm) sample into about a byte when
+   samples are evenly spaced and CO2 changes slowly, so a 4KB buffer holds
+   days of one-a-minute readings instead of hours.
+
+   When the buffer is full it is printed as hex (in place of an uplink) and
+   cleared. Save the bytes to a file and decode on a PC with
+   extras/Host/Series: ./Series -d buffer.bin
+
+   *Note: timestamps are in seconds, which compress better than millis()
+   since the sample period then stays exactly constant.
+*/
+
+#include <Arduino.h>
+#include "MHZ19.h"
+#include "MHZ19Series.h"
+
+#define RX_PIN 10
+#define TX_PIN 11
+#define BAUDRATE 9600                                      // Native to the sensor (do not change)
+#define SAMPLE_PERIOD 60000UL                              // One sample a minute
+
+#if defined(ESP32)
+#define SERIES_BUFFER 4096
+#else
+#define SERIES_BUFFER 768                                  // An Uno has 2KB of RAM in all
+#endif
+
+MHZ19 myMHZ19;
+MHZ19Series mySeries;
+#if defined(ESP32)
+HardwareSerial mySerial(2);                                // On ESP32 we do not require the SoftwareSerial library, since we have 2 USARTS available
+#else
+#include <SoftwareSerial.h>                                //  Remove if using HardwareSerial or non-uno compatible device
+SoftwareSerial mySerial(RX_PIN, TX_PIN);                   // (Uno example) create device to MH-Z19 serial
+#endif
+
+byte seriesBuffer[SERIES_BUFFER];
+unsigned long getDataTimer = 0;
+
+void sendBatch()
+{
+    const byte *data = mySeries.getBuffer();
+
+    Serial.print("Batch of ");
+    Serial.print(mySeries.getCount());
+    Serial.print(" samples, bytes: ");
+    Serial.println(mySeries.getSize());
+
+    for (size_t i = 0; i < mySeries.getSize(); i++)
+    {
+        if (data[i] < 0x10)
+            Serial.print('0');
+        Serial.print(data[i], HEX);
+    }
+    Serial.println();
+
+    mySeries.clear();
+}
+
+void setup()
+{
+    Serial.begin(9600);
+
+    mySerial.begin(BAUDRATE);                               // (Uno example) device to MH-Z19 serial start
+    myMHZ19.begin(mySerial);                                // *Serial(Stream) reference must be passed to library begin().
+
+    myMHZ19.autoCalibration(false);
+    myMHZ19.setFilter(true, true);                          // Warm-up readings are errors, not stored
+
+    mySeries.begin(seriesBuffer, sizeof(seriesBuffer));
+}
+
+void loop()
+{
+    if (millis() - getDataTimer >= SAMPLE_PERIOD)
+    {
+        getDataTimer += SAMPLE_PERIOD;                      // Keeps the period exact, for the timestamp coding
+
+        int CO2 = myMHZ19.getCO2();
+
+        if (myMHZ19.errorCode != RESULT_OK)
+            return;
+
+        unsigned long timestamp = getDataTimer / 1000;
+
+        if (!mySeries.append(timestamp, CO2))
+        {
+            sendBatch();
+            mySeries.append(timestamp, CO2);
+        }
+    }
+}
@@ -0,0 +1,103 @@
+/*
+   Sharing one sensor between tasks (e.g. FreeRTOS on ESP32).
+
+   errorCode and the response buffers of MHZ19 belong to whichever call ran
+   last, so two tasks using it directly can read each other's results. Once
+   shared, use the sensor only through MHZ19Safe: requests are queued and sent
+   one at a time, and every call returns its own result (value, error code,
+   time and command byte).
+
+   On boards without tasks, the same calls simply run in order.
+*/
+
+#include <Arduino.h>
+#include "MHZ19.h"
+#include "MHZ19Safe.h"
+
+#define RX_PIN 10
+#define TX_PIN 11
+#define BAUDRATE 9600                                      // Native to the sensor (do not change)
+
+MHZ19 myMHZ19;
+MHZ19Safe mySafeMHZ19(myMHZ19);                            // Facade used by all tasks
+#if defined(ESP32)
+HardwareSerial mySerial(2);                                // On ESP32 we do not require the SoftwareSerial library, since we have 2 USARTS available
+#else
+#include <SoftwareSerial.h>                                //  Remove if using HardwareSerial or non-uno compatible device
+SoftwareSerial mySerial(RX_PIN, TX_PIN);                   // (Uno example) create device to MH-Z19 serial
+#endif
+
+void printCO2()
+{
+    MHZ19Result<int> CO2 = mySafeMHZ19.getCO2();           // Result belongs to this call only
+
+    if (CO2.ok())
+    {
+        Serial.print("CO2 (ppm): ");
+        Serial.println(CO2.value);
+    }
+    else
+    {
+        Serial.print("CO2 failed, Error Code: ");
+        Serial.println(CO2.error);
+    }
+}
+
+void printTemperature()
+{
+    MHZ19Result<int> temp = mySafeMHZ19.getTemperatureCenti();
+
+    if (temp.ok())
+    {
+        Serial.print("Temperature (C/100): ");
+        Serial.println(temp.value);
+    }
+}
+
+#if defined(ESP32)
+void co2Task(void *)
+{
+    for (;;)
+    {
+        printCO2();
+        vTaskDelay(pdMS_TO_TICKS(2000));
+    }
+}
+
+void temperatureTask(void *)
+{
+    for (;;)
+    {
+        printTemperature();
+        vTaskDelay(pdMS_TO_TICKS(5000));
+    }
+}
+#endif
+
+unsigned long getDataTimer = 0;
+
+void setup()
+{
+    Serial.begin(9600);
+
+    mySerial.begin(BAUDRATE);                               // (Uno example) device to MH-Z19 serial start
+    myMHZ19.begin(mySerial);                                // *Serial(Stream) reference must be passed to library begin().
+
+#if defined(ESP32)
+    xTaskCreate(co2Task, "co2", 4096, NULL, 1, NULL);
+    xTaskCreate(temperatureTask, "temp", 4096, NULL, 1, NULL);
+#endif
+}
+
+void loop()
+{
+#if !defined(ESP32)
+    if (millis() - getDataTimer >= 2000)
+    {
+        printCO2();
+        printTemperature();
+
+        getDataTimer = millis();
+    }
+#endif
+}
@@ -0,0 +1,319 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#include "Arduino.h"
+
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+HostSerial Serial;
+
+/*########################-Time-##########################*/
+
+static bool isVirtualClock = false;
+static uint64_t virtualMicros = 0;
+static void (*idleHook)() = NULL;
+
+static uint64_t systemMicros()
+{
+    static uint64_t origin = 0;
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    uint64_t now = (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+
+    if (!origin)
+        origin = now;
+
+    return now - origin;
+}
+
+uint64_t hostMicros64()
+{
+    return isVirtualClock ? virtualMicros : systemMicros();
+}
+
+unsigned long millis()
+{
+    return (unsigned long)(hostMicros64() / 1000);
+}
+
+unsigned long micros()
+{
+    return (unsigned long)hostMicros64();
+}
+
+void delay(unsigned long ms)
+{
+    if (isVirtualClock)
+    {
+        uint64_t until = virtualMicros + (uint64_t)ms * 1000;
+
+        /* let the idle hook run through the delay, it may advance the clock itself */
+        while (virtualMicros < until)
+        {
+            uint64_t before = virtualMicros;
+
+            yield();
+
+            if (virtualMicros == before)
+                virtualMicros = until;
+        }
+    }
+    else
+        usleep(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    if (isVirtualClock)
+        virtualMicros += us;
+    else
+        usleep(us);
+}
+
+void yield()
+{
+    if (isVirtualClock && idleHook)
+        idleHook();
+    else if (!isVirtualClock)
+        sched_yield();
+}
+
+void hostUseVirtualClock(bool isVirtual)
+{
+    if (isVirtual && !isVirtualClock)
+        virtualMicros = systemMicros();
+
+    isVirtualClock = isVirtual;
+}
+
+void hostAdvanceMicros(uint64_t us)
+{
+    virtualMicros += us;
+}
+
+void hostSetIdleHook(void (*hook)())
+{
+    idleHook = hook;
+}
+
+/*########################-Pins-##########################*/
+
+static uint8_t pinLevel[HOST_PINS];
+static int pinAnalog[HOST_PINS];
+static void (*pinISR[HOST_PINS])();
+static int pinISRMode[HOST_PINS];
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (pin < HOST_PINS && mode == INPUT_PULLUP)
+        pinLevel[pin] = HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    if (pin < HOST_PINS)
+        pinLevel[pin] = val ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin)
+{
+    return pin < HOST_PINS ? pinLevel[pin] : LOW;
+}
+
+int analogRead(uint8_t pin)
+{
+    return pin < HOST_PINS ? pinAnalog[pin] : 0;
+}
+
+void attachInterrupt(uint8_t interrupt, void (*isr)(), int mode)
+{
+    if (interrupt < HOST_PINS)
+    {
+        pinISR[interrupt] = isr;
+        pinISRMode[interrupt] = mode;
+    }
+}
+
+void detachInterrupt(uint8_t interrupt)
+{
+    if (interrupt < HOST_PINS)
+        pinISR[interrupt] = NULL;
+}
+
+/* the host is single threaded as far as the library is concerned */
+void noInterrupts() {}
+void interrupts() {}
+
+void hostPinWrite(uint8_t pin, uint8_t val)
+{
+    if (pin >= HOST_PINS)
+        return;
+
+    uint8_t last = pinLevel[pin];
+    pinLevel[pin] = val ? HIGH : LOW;
+
+    if (!pinISR[pin] || last == pinLevel[pin])
+        return;
+
+    if (pinISRMode[pin] == CHANGE
+        || (pinISRMode[pin] == RISING && pinLevel[pin] == HIGH)
+        || (pinISRMode[pin] == FALLING && pinLevel[pin] == LOW))
+        pinISR[pin]();
+}
+
+void hostAnalogWrite(uint8_t pin, int val)
+{
+    if (pin < HOST_PINS)
+        pinAnalog[pin] = val;
+}
+
+uint8_t hostPinRead(uint8_t pin)
+{
+    return pin < HOST_PINS ? pinLevel[pin] : LOW;
+}
+
+/*########################-Print / Stream-##########################*/
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t n = 0;
+
+    while (size--)
+        n += write(*buffer++);
+
+    return n;
+}
+
+size_t Print::print(long n, int base)
+{
+    if (base == DEC)
+    {
+        char text[24];
+        snprintf(text, sizeof(text), "%ld", n);
+        return write(text);
+    }
+    return print((unsigned long)n, base);
+}
+
+size_t Print::print(unsigned long n, int base)
+{
+    return print((unsigned long long)n, base);
+}
+
+size_t Print::print(long long n, int base)
+{
+    if (base == DEC)
+    {
+        char text[24];
+        snprintf(text, sizeof(text), "%lld", n);
+        return write(text);
+    }
+    return print((unsigned long long)n, base);
+}
+
+size_t Print::print(unsigned long long n, int base)
+{
+    char text[66];
+    char *p = &text[sizeof(text) - 1];
+
+    if (base < 2)
+        base = DEC;
+
+    *p = '\0';
+    do
+    {
+        *--p = "0123456789ABCDEF"[n % base];
+        n /= base;
+    } while (n);
+
+    return write(p);
+}
+
+size_t Print::print(double n, int digits)
+{
+    char text[48];
+    snprintf(text, sizeof(text), "%.*f", digits, n);
+    return write(text);
+}
+
+int Stream::timedRead()
+{
+    unsigned long start = millis();
+
+    do
+    {
+        int c = read();
+
+        if (c >= 0)
+            return c;
+
+        yield();
+    } while (millis() - start < this->timeout);
+
+    return -1;
+}
+
+size_t Stream::readBytes(uint8_t *buffer, size_t length)
+{
+    size_t count = 0;
+
+    while (count < length)
+    {
+        int c = timedRead();
+
+        if (c < 0)
+            break;
+
+        buffer[count++] = (uint8_t)c;
+    }
+    return count;
+}
+
+/*########################-HostUART-##########################*/
+
+size_t HostUART::write(uint8_t c)
+{
+    if (this->transmitHook)
+        this->transmitHook(c, this->transmitContext);
+
+    return 1;
+}
+
+int HostUART::read()
+{
+    if (!this->count)
+        return -1;
+
+    uint8_t c = this->fifo[this->head];
+
+    this->head = (this->head + 1) % HOST_UART_FIFO;
+    this->count--;
+
+    return c;
+}
+
+void HostUART::hostSetTransmitHook(void (*hook)(uint8_t c, void *context), void *context)
+{
+    this->transmitHook = hook;
+    this->transmitContext = context;
+}
+
+size_t HostUART::hostReceive(const uint8_t *data, size_t len)
+{
+    size_t queued = 0;
+
+    /* bytes beyond the FIFO are lost, as on an overrun UART */
+    while (queued < len && this->count < HOST_UART_FIFO)
+    {
+        this->fifo[(this->head + this->count) % HOST_UART_FIFO] = data[queued++];
+        this->count++;
+    }
+
+    if (queued && this->receiveEvent)
+        this->receiveEvent();
+
+    return queued;
+}
@@ -0,0 +1,207 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+/*
+   Minimal Arduino core for building the library on a PC (Linux / macOS).
+   Only what the library and host tools use is provided. Time can follow the
+   system clock or a virtual clock which the host program advances, and pins
+   are plain variables so programs can drive inputs and interrupts.
+*/
+
+#ifndef MHZ19_HOST_ARDUINO_H
+#define MHZ19_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <functional>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define HOST_PINS 64
+#define NOT_AN_INTERRUPT -1
+#define digitalPinToInterrupt(p) ((p) < HOST_PINS ? (p) : NOT_AN_INTERRUPT)
+
+/* flash is ordinary memory on the host */
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_ptr(addr) (*(void *const *)(addr))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(PSTR(s)))
+
+/*########################-Time-##########################*/
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+/* switches between the system clock (default) and a virtual clock */
+void hostUseVirtualClock(bool isVirtual = true);
+
+/* advances the virtual clock, no effect on the system clock */
+void hostAdvanceMicros(uint64_t us);
+
+/* current time in microseconds, 64 bit so it never wraps in a simulation */
+uint64_t hostMicros64();
+
+/* called by yield() and delay() while on the virtual clock, e.g. to step a simulation */
+void hostSetIdleHook(void (*hook)());
+
+/*########################-Pins-##########################*/
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+
+void attachInterrupt(uint8_t interrupt, void (*isr)(), int mode);
+void detachInterrupt(uint8_t interrupt);
+void noInterrupts();
+void interrupts();
+
+/* drives an input pin, firing an attached interrupt on a matching edge */
+void hostPinWrite(uint8_t pin, uint8_t val);
+
+/* sets the value returned by analogRead() */
+void hostAnalogWrite(uint8_t pin, int val);
+
+/* returns what the library last wrote to an output pin */
+uint8_t hostPinRead(uint8_t pin);
+
+/*########################-Print / Stream-##########################*/
+
+class Print
+{
+  public:
+	virtual ~Print() {}
+
+	virtual size_t write(uint8_t c) = 0;
+	virtual size_t write(const uint8_t *buffer, size_t size);
+	size_t write(const char *str) { return str ? write((const uint8_t *)str, strlen(str)) : 0; }
+	size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+	virtual void flush() {}
+
+	size_t print(const __FlashStringHelper *str) { return write((const char *)str); }
+	size_t print(const char str[]) { return write(str); }
+	size_t print(char c) { return write((uint8_t)c); }
+	size_t print(unsigned char n, int base = DEC) { return print((unsigned long)n, base); }
+	size_t print(int n, int base = DEC) { return print((long)n, base); }
+	size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); }
+	size_t print(long n, int base = DEC);
+	size_t print(unsigned long n, int base = DEC);
+	size_t print(long long n, int base = DEC);
+	size_t print(unsigned long long n, int base = DEC);
+	size_t print(double n, int digits = 2);
+
+	size_t println() { return write("\r\n"); }
+	template <typename T> size_t println(T value) { size_t n = print(value); return n + println(); }
+	template <typename T> size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+};
+
+class Stream : public Print
+{
+  public:
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+
+	void setTimeout(unsigned long timeout) { this->timeout = timeout; }
+	unsigned long getTimeout() { return this->timeout; }
+
+	size_t readBytes(uint8_t *buffer, size_t length);
+	size_t readBytes(char *buffer, size_t length) { return readBytes((uint8_t *)buffer, length); }
+
+  protected:
+	unsigned long timeout = 1000;
+
+	/* reads a byte, waiting up to timeout, -1 on timeout */
+	int timedRead();
+};
+
+/* the console, Serial output goes to stdout and it never receives */
+class HostSerial : public Stream
+{
+  public:
+	void begin(unsigned long) {}
+	void end() {}
+	operator bool() { return true; }
+
+	size_t write(uint8_t c) { return fputc(c, stdout) == EOF ? 0 : 1; }
+	size_t write(const uint8_t *buffer, size_t size) { return fwrite(buffer, 1, size, stdout); }
+	using Print::write;
+	void flush() { fflush(stdout); }
+
+	int available() { return 0; }
+	int read() { return -1; }
+	int peek() { return -1; }
+};
+
+extern HostSerial Serial;
+
+/* a UART whose far end is the host program (e.g. a simulated sensor). Bytes the
+ * library writes go to the transmit hook, bytes given to hostReceive() are queued
+ * for reading and fire the onReceive() event, as HardwareSerial does on ESP32
+ */
+#define HOST_UART_FIFO 256
+
+class HostUART : public Stream
+{
+  public:
+	void begin(unsigned long) {}
+	void end() {}
+	operator bool() { return true; }
+
+	size_t write(uint8_t c);
+	using Print::write;
+
+	int available() { return this->count; }
+	int read();
+	int peek() { return this->count ? this->fifo[this->head] : -1; }
+
+	/* receive event, called after bytes arrive (ESP32 signature) */
+	void onReceive(std::function<void(void)> callback, bool /* onlyOnTimeout */ = false) { this->receiveEvent = callback; }
+
+	/* called with each byte the library writes */
+	void hostSetTransmitHook(void (*hook)(uint8_t c, void *context), void *context = NULL);
+
+	/* queues bytes as if received on the line then fires the receive event, returns bytes queued */
+	size_t hostReceive(const uint8_t *data, size_t len);
+
+  private:
+	uint8_t fifo[HOST_UART_FIFO];
+	size_t head = 0;
+	size_t count = 0;
+
+	std::function<void(void)> receiveEvent;
+	void (*transmitHook)(uint8_t c, void *context) = NULL;
+	void *transmitContext = NULL;
+};
+
+#endif
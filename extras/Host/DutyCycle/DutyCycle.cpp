@@ -0,0 +1,113 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+/*
+   Host tool: measures wake-ups of a duty-cycled node which sleeps until
+   nextDeadline(), against MHZ19Sim on a virtual clock.
+
+   The node samples once a minute with requestCO2() / receive(), keeps ABC OFF
+   (resent every 12 hours by maintenance) and otherwise sleeps. The library is
+   given its own clock through setClock(), started just short of rollover so
+   the deadline arithmetic is exercised across it. Wake-ups per hour are
+   compared with polling every 100ms.
+
+   Build (from this folder):
+     g++ -std=gnu++11 -O2 -I.. -I../../../src -o DutyCycle DutyCycle.cpp ../Arduino.cpp ../MHZ19Sim.cpp ../../../src/MHZ19*.cpp
+   Usage:
+     ./DutyCycle [hours]
+*/
+
+#include <Arduino.h>
+#include "MHZ19.h"
+#include "MHZ19Sim.h"
+
+#define SAMPLE_PERIOD 60000UL       // ms
+#define POLL_PERIOD 100             // ms, the naive alternative
+
+MHZ19Sim sim;
+MHZ19 sensor;
+
+/* an RTC style clock, 10 minutes short of rollover at start */
+static unsigned long rtc()
+{
+    /* wraps at the width of unsigned long, as millis() does */
+    return (unsigned long)0 - 600000UL + (unsigned long)(hostMicros64() / 1000);
+}
+
+/* blocking calls (begin(), maintenance) step the clock while waiting */
+static void idle()
+{
+    hostAdvanceMicros(200);
+}
+
+int main(int argc, char *argv[])
+{
+    int hours = argc > 1 ? atoi(argv[1]) : 48;
+
+    if (hours < 1)
+        hours = 1;
+
+    hostUseVirtualClock();
+    hostSetIdleHook(idle);
+
+    sim.setDrift(0, 5);
+    sim.begin("0443", 2000, 7);
+
+    sensor.setClock(rtc);
+    sensor.begin(sim);
+    sensor.autoCalibration(false);
+    sensor.autoMaintenance(false);
+    sensor.setSamplePeriod(SAMPLE_PERIOD);
+
+    uint64_t start = hostMicros64();
+    uint64_t end = start + (uint64_t)hours * 3600000000ULL;
+
+    unsigned long wakeups = 0, samples = 0, valid = 0, idleWakeups = 0;
+
+    while (hostMicros64() < end)
+    {
+        /* sleep */
+        hostAdvanceMicros((uint64_t)sensor.untilDeadline() * 1000);
+        wakeups++;
+
+        bool isWork = false;
+
+        if (sensor.isPending())
+        {
+            isWork = true;
+
+            if (sensor.receive())
+            {
+                samples++;
+
+                if (sensor.errorCode == RESULT_OK)
+                    valid++;
+            }
+        }
+        else if (sensor.sampleDue())
+        {
+            isWork = true;
+            sensor.requestCO2();
+        }
+
+        if (!isWork)
+            idleWakeups++;
+    }
+
+    double simulated = (double)(hostMicros64() - start) / 3600000000.0;
+    unsigned long expected = (unsigned long)(simulated * 3600000UL / SAMPLE_PERIOD);
+
+    printf("Simulated %.1f hours, library clock now %lu (started 10 minutes before rollover)\n", simulated, rtc());
+    printf("Samples %lu (%lu valid, %lu expected)\n", samples, valid, expected);
+    printf("ABC OFF sent %lu times\n", sim.getCommandCount(0x79));
+    printf("Wake-ups %lu (%.1f per hour, %lu with nothing to do)\n", wakeups, wakeups / simulated, idleWakeups);
+    printf("Polling every %dms would wake %.0f per hour\n", POLL_PERIOD, 3600000.0 / POLL_PERIOD);
+
+    /* each sample needs a wake to request and one to collect, maintenance adds a few */
+    bool failed = samples + 1 < expected || valid < samples * 9 / 10
+                  || wakeups > samples * 2 + idleWakeups + (unsigned long)hours
+                  || sim.getCommandCount(0x79) < (unsigned long)hours / 12;
+
+    printf("%s\n", failed ? "FAIL" : "PASS");
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,366 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+/*
+   Host tool: a Linux gateway daemon reading up to 64 sensors on separate ttys
+   from one epoll loop (MHZ19Gateway.h), publishing every reading into a shared
+   memory ring (MHZ19Shm.h) for local consumer processes.
+
+   -r is such a consumer, printing readings as they are published.
+
+   -b benchmarks against simulated sensors: each port is a pty pair with
+   MHZ19Sim behind its master, served by one thread on the system clock, so
+   replies keep the sensor's latency and 9600 baud timing. Ports are requested
+   back to back, and consumer processes read the ring while it runs. It
+   reports the sweep rate (readings of every port per second) and the loop's
+   CPU time, and exits non-zero if a request failed, or a consumer missed a
+   reading, saw one out of order or read a torn slot.
+
+   Build (from this folder):
+     g++ -std=gnu++11 -O2 -pthread -I.. -I../../../src -o Gateway Gateway.cpp ../Arduino.cpp ../PosixSerial.cpp ../MHZ19Gateway.cpp ../MHZ19Shm.cpp ../MHZ19Sim.cpp ../../../src/MHZ19*.cpp -lrt
+   Usage:
+     ./Gateway [-n name] [-i interval ms] tty...
+     ./Gateway -r [-n name]
+     ./Gateway -b [ports] [seconds]
+*/
+
+#include <Arduino.h>
+#include <atomic>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include "MHZ19Gateway.h"
+#include "MHZ19Shm.h"
+#include "MHZ19Sim.h"
+
+#define SHM_NAME "/mhz19"
+#define INTERVAL 5000UL             // ms between readings of a port
+#define BENCH_PORTS 64
+#define BENCH_SECONDS 10
+#define BENCH_CONSUMERS 2           // reader processes
+#define CONSUMER_SLEEP 1000         // reader poll when the ring is idle (us)
+
+MHZ19ShmWriter ring;
+MHZ19Gateway gateway;
+
+void onSignal(int)
+{
+    gateway.stop();
+}
+
+/*########################-Consumer-##########################*/
+
+/* reads the ring until the writer closes it, returns non-zero on a missed, out of order or torn reading */
+int consume(const char *name, bool isPrinted, byte ports)
+{
+    MHZ19ShmReader reader;
+
+    if (!reader.begin(name))
+    {
+        fprintf(stderr, "%s: %s\n", name, strerror(errno));
+        return 1;
+    }
+
+    MHZ19ShmSample sample;
+    uint16_t expected[MHZ19SHM_PORTS];
+    bool isSeen[MHZ19SHM_PORTS] = { false };
+    unsigned long count = 0, gaps = 0, wrong = 0;
+
+    for (;;)
+    {
+        /* taken first, as the writer closes only after its last reading */
+        bool isClosed = reader.isClosed();
+
+        if (!reader.next(sample))
+        {
+            if (isClosed)
+                break;
+
+            usleep(CONSUMER_SLEEP);
+            continue;
+        }
+
+        count++;
+
+        if (sample.port >= MHZ19SHM_PORTS || (ports && sample.port >= ports))
+        {
+            wrong++;
+            continue;
+        }
+
+        if (isSeen[sample.port] && sample.count != expected[sample.port])
+            gaps++;
+
+        isSeen[sample.port] = true;
+        expected[sample.port] = sample.count + 1;
+
+        if (sample.result == RESULT_OK && (sample.ppm < 0 || sample.ppm > 10000))
+            wrong++;
+
+        if (isPrinted)
+        {
+            time_t seconds = sample.time / 1000000;
+            char at[16];
+
+            strftime(at, sizeof(at), "%H:%M:%S", localtime(&seconds));
+
+            if (sample.result == RESULT_OK)
+                printf("%s  port %2u  %5d ppm  %5.2f C\n", at, sample.port, sample.ppm, sample.centi / 100.0);
+            else
+                printf("%s  port %2u  error %u\n", at, sample.port, sample.result);
+
+            fflush(stdout);
+        }
+    }
+
+    if (!isPrinted)
+        printf("consumer %d: %lu readings of %llu, lost %llu, torn %llu, gaps %lu, wrong %lu\n", (int)getpid(), count,
+               (unsigned long long)reader.getHead(), (unsigned long long)reader.getLost(),
+               (unsigned long long)reader.getTorn(), gaps, wrong);
+
+    /* consumers leave with _exit(), which does not flush */
+    fflush(stdout);
+
+    return count != reader.getHead() || reader.getLost() || reader.getTorn() || gaps || wrong;
+}
+
+/*########################-Benchmark-##########################*/
+
+MHZ19Sim sims[BENCH_PORTS];
+int masters[BENCH_PORTS];
+char slaves[BENCH_PORTS][32];
+std::atomic<bool> isBenchDone(false);
+
+/* relays every pty master to and from its simulated sensor */
+void playSensors(byte ports)
+{
+    struct pollfd fds[BENCH_PORTS];
+    uint8_t buffer[64];
+
+    for (byte i = 0; i < ports; i++)
+    {
+        fds[i].fd = masters[i];
+        fds[i].events = POLLIN;
+    }
+
+    while (!isBenchDone)
+    {
+        /* wakes for requests, or each ms to release queued reply bytes on time */
+        poll(fds, ports, 1);
+
+        for (byte i = 0; i < ports; i++)
+        {
+            ssize_t n = fds[i].revents & POLLIN ? read(masters[i], buffer, sizeof(buffer)) : 0;
+
+            for (ssize_t b = 0; b < n; b++)
+                sims[i].write(buffer[b]);
+
+            size_t out = 0;
+
+            while (out < sizeof(buffer) && sims[i].available())
+                buffer[out++] = sims[i].read();
+
+            if (out && write(masters[i], buffer, out) < 0)
+                continue;
+        }
+    }
+}
+
+double seconds(clockid_t clock)
+{
+    struct timespec ts;
+
+    clock_gettime(clock, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int benchmark(byte ports, unsigned long duration)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "/mhz19-bench-%d", (int)getpid());
+
+    /* starts the shim's clock before the sensors' thread reads it */
+    millis();
+
+    for (byte i = 0; i < ports; i++)
+    {
+        masters[i] = posix_openpt(O_RDWR | O_NOCTTY);
+
+        if (masters[i] < 0 || grantpt(masters[i]) < 0 || unlockpt(masters[i]) < 0)
+        {
+            perror("pty");
+            return 1;
+        }
+
+        fcntl(masters[i], F_SETFL, fcntl(masters[i], F_GETFL) | O_NONBLOCK);
+        snprintf(slaves[i], sizeof(slaves[i]), "%s", ptsname(masters[i]));
+
+        sims[i].setWarmup(0);
+        sims[i].begin("0443", 2000, i + 1);
+    }
+
+    if (!ring.begin(name))
+    {
+        perror(name);
+        return 1;
+    }
+
+    /* consumers before any thread, so they fork with nothing running */
+    pid_t consumers[BENCH_CONSUMERS];
+
+    for (byte c = 0; c < BENCH_CONSUMERS; c++)
+    {
+        consumers[c] = fork();
+
+        if (consumers[c] == 0)
+            _exit(consume(name, false, ports));
+    }
+
+    std::thread sensorThread(playSensors, ports);
+
+    double startup = seconds(CLOCK_MONOTONIC);
+
+    gateway.begin(ring, 0);
+
+    for (byte i = 0; i < ports; i++)
+        gateway.addPort(slaves[i]);
+
+    startup = seconds(CLOCK_MONOTONIC) - startup;
+
+    double wall = seconds(CLOCK_MONOTONIC);
+    double cpu = seconds(CLOCK_THREAD_CPUTIME_ID);
+
+    gateway.run(duration * 1000);
+
+    wall = seconds(CLOCK_MONOTONIC) - wall;
+    cpu = seconds(CLOCK_THREAD_CPUTIME_ID) - cpu;
+
+    unsigned long samples = 0, failures = 0, idle = 0;
+
+    for (byte i = 0; i < ports; i++)
+    {
+        samples += gateway.getPort(i).samples;
+        failures += gateway.getPort(i).failures;
+
+        if (!gateway.getPort(i).samples)
+            idle++;
+    }
+
+    unsigned long published = (unsigned long)ring.getHead();
+
+    gateway.end();
+    ring.end();
+
+    isBenchDone = true;
+    sensorThread.join();
+
+    bool failed = false;
+
+    for (byte c = 0; c < BENCH_CONSUMERS; c++)
+    {
+        int status;
+
+        if (waitpid(consumers[c], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status))
+            failed = true;
+    }
+
+    double sweeps = samples / (double)ports / wall;
+
+    printf("%u ports opened and verified in %.2fs\n", ports, startup);
+    printf("%.1fs: %lu readings published, %lu failed, %lu ports without a reading\n", wall, published, failures, idle);
+    printf("sweep rate %.1f /s (every port every %.1f ms), %.0f readings/s\n", sweeps, sweeps > 0 ? 1000 / sweeps : 0.0,
+           samples / wall);
+    printf("loop: %.3fs CPU (%.1f%%), %lu wakes, %.2f per reading\n", cpu, 100 * cpu / wall, gateway.getWakes(),
+           samples ? (double)gateway.getWakes() / samples : 0.0);
+
+    if (failures || idle || !samples)
+        failed = true;
+
+    printf("%s\n", failed ? "FAIL" : "PASS");
+
+    return failed ? 1 : 0;
+}
+
+/*########################-Daemon-##########################*/
+
+int main(int argc, char *argv[])
+{
+    const char *name = SHM_NAME;
+    unsigned long interval = INTERVAL;
+    int arg = 1;
+
+    if (argc > 1 && !strcmp(argv[1], "-b"))
+    {
+        int ports = argc > 2 ? atoi(argv[2]) : BENCH_PORTS;
+        unsigned long duration = argc > 3 ? strtoul(argv[3], NULL, 10) : BENCH_SECONDS;
+
+        if (ports < 1 || ports > BENCH_PORTS)
+            ports = BENCH_PORTS;
+
+        return benchmark(ports, duration ? duration : BENCH_SECONDS);
+    }
+
+    bool isConsumer = argc > 1 && !strcmp(argv[1], "-r");
+
+    if (isConsumer)
+        arg++;
+
+    for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2)
+    {
+        if (!strcmp(argv[arg], "-n"))
+            name = argv[arg + 1];
+        else if (!strcmp(argv[arg], "-i"))
+            interval = strtoul(argv[arg + 1], NULL, 10);
+    }
+
+    if (isConsumer)
+        return consume(name, true, 0);
+
+    if (arg >= argc)
+    {
+        fprintf(stderr, "usage: %s [-n name] [-i interval ms] tty...\n       %s -r [-n name]\n       %s -b [ports] [seconds]\n",
+                argv[0], argv[0], argv[0]);
+        return 2;
+    }
+
+    if (!ring.begin(name) || !gateway.begin(ring, interval))
+    {
+        perror(name);
+        return 1;
+    }
+
+    for (; arg < argc; arg++)
+    {
+        int port = gateway.addPort(argv[arg]);
+
+        if (port < 0)
+        {
+            fprintf(stderr, "%s: more than %d ports\n", argv[arg], MHZ19GATEWAY_PORTS);
+            continue;
+        }
+
+        MHZ19GatewayPort &p = gateway.getPort(port);
+
+        printf("port %2d  %s  %s\n", port, p.path, p.state == GATEWAY_CLOSED ? "not open, retrying" : p.isIdentified ? "verified" : "no reply");
+    }
+
+    fflush(stdout);
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    gateway.run();
+
+    for (byte i = 0; i < gateway.getPorts(); i++)
+        printf("port %2u  %lu readings, %lu failed\n", i, gateway.getPort(i).samples, gateway.getPort(i).failures);
+
+    gateway.end();
+    ring.end();
+
+    return 0;
+}
@@ -0,0 +1,233 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#include "MHZ19Gateway.h"
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
+/*#####################-Initiation Functions-#####################*/
+
+bool MHZ19Gateway::begin(MHZ19ShmWriter &ring, unsigned long interval)
+{
+    end();
+
+    this->epoll = epoll_create1(EPOLL_CLOEXEC);
+
+    if (this->epoll < 0)
+        return false;
+
+    this->ring = &ring;
+    this->interval = interval;
+    this->wakes = 0;
+
+    return true;
+}
+
+int MHZ19Gateway::addPort(const char *path)
+{
+    if (this->ports >= MHZ19GATEWAY_PORTS || this->epoll < 0)
+        return -1;
+
+    byte index = this->ports++;
+    MHZ19GatewayPort &p = this->port[index];
+
+    p.path = path;
+    p.isIdentified = false;
+    p.state = GATEWAY_CLOSED;
+    p.samples = 0;
+    p.failures = 0;
+
+    /* a port which fails to open is retried from the loop */
+    if (!open(index))
+        p.due = millis() + MHZ19GATEWAY_RETRY;
+
+    return index;
+}
+
+void MHZ19Gateway::end()
+{
+    for (byte i = 0; i < this->ports; i++)
+        this->port[i].serial.end();
+
+    if (this->epoll >= 0)
+        close(this->epoll);
+
+    this->epoll = -1;
+    this->ports = 0;
+}
+
+/*######################-Utility Functions-########################*/
+
+void MHZ19Gateway::run(unsigned long ms)
+{
+    struct epoll_event events[MHZ19GATEWAY_EVENTS];
+    uint32_t ready[MHZ19GATEWAY_PORTS];
+    unsigned long start = millis();
+
+    this->isStopped = false;
+
+    while (!this->isStopped)
+    {
+        unsigned long now = millis();
+
+        if (ms && now - start >= ms)
+            break;
+
+        /* sleeps until the earliest port deadline, or the end of the run */
+        long timeout = ms ? (long)(start + ms - now) : (long)MHZ19_NO_DEADLINE;
+
+        for (byte i = 0; i < this->ports; i++)
+        {
+            long until = (long)(deadline(i) - now);
+
+            if (until < timeout)
+                timeout = until;
+        }
+
+        int count = epoll_wait(this->epoll, events, MHZ19GATEWAY_EVENTS, timeout > 0 ? (int)timeout : 0);
+
+        this->wakes++;
+
+        if (count < 0 && errno != EINTR)
+            break;
+
+        memset(ready, 0, sizeof(ready));
+
+        for (int e = 0; e < count; e++)
+            ready[events[e].data.u32] = events[e].events;
+
+        now = millis();
+
+        for (byte i = 0; i < this->ports; i++)
+        {
+            /* a tty whose far end has gone reads as empty, but would wake epoll for good */
+            if (ready[i] & (EPOLLHUP | EPOLLERR))
+                this->port[i].serial.end();
+
+            if (ready[i] || (long)(now - deadline(i)) >= 0)
+                step(i, ready[i] != 0);
+        }
+    }
+}
+
+/*######################-Internal Functions-########################*/
+
+bool MHZ19Gateway::open(byte index)
+{
+    MHZ19GatewayPort &p = this->port[index];
+
+    if (!p.serial.begin(p.path, 9600))
+        return false;
+
+    /* first time verified by begin(), waiting in poll() a few ms at a time. After that the
+     * saved identity reopens without communicating
+     */
+    if (p.isIdentified)
+        p.sensor.begin(p.serial, p.identity);
+    else
+    {
+        p.serial.setWait(POSIXSERIAL_WAIT);
+
+        if (p.sensor.begin(p.serial) == 0)
+            p.isIdentified = p.sensor.getIdentity(p.identity);
+    }
+
+    /* the loop waits in epoll, and receive() must not wait at all */
+    p.serial.setWait(0);
+
+    struct epoll_event event;
+
+    event.events = EPOLLIN;
+    event.data.u64 = 0;
+    event.data.u32 = index;
+
+    if (epoll_ctl(this->epoll, EPOLL_CTL_ADD, p.serial.getFD(), &event) < 0)
+    {
+        p.serial.end();
+        return false;
+    }
+
+    p.state = GATEWAY_IDLE;
+    p.due = millis();
+
+    return true;
+}
+
+void MHZ19Gateway::step(byte index, bool isReadable)
+{
+    MHZ19GatewayPort &p = this->port[index];
+    unsigned long now = millis();
+
+    if (p.state == GATEWAY_CLOSED)
+    {
+        if (!open(index))
+            p.due = now + MHZ19GATEWAY_RETRY;
+
+        return;
+    }
+
+    /* completes or times out the request */
+    if (p.state == GATEWAY_PENDING && p.sensor.receive())
+    {
+        publish(index);
+        p.state = GATEWAY_IDLE;
+    }
+    else if (p.state == GATEWAY_IDLE && isReadable)
+    {
+        /* bytes nobody asked for, which would keep epoll waking */
+        while (p.serial.read() >= 0)
+            ;
+    }
+
+    /* hung up, closing its descriptor also removed it from epoll. A request in flight
+     * times out first, so it is published and the library is not left pending
+     */
+    if (!p.serial && p.state != GATEWAY_PENDING)
+    {
+        p.state = GATEWAY_CLOSED;
+        p.due = now + MHZ19GATEWAY_RETRY;
+        return;
+    }
+
+    if (p.state == GATEWAY_IDLE && (long)(now - p.due) >= 0 && p.sensor.requestCO2())
+    {
+        p.state = GATEWAY_PENDING;
+
+        /* a port which fell behind carries on from now, rather than bursting to catch up */
+        p.due += this->interval;
+
+        if ((long)(now - p.due) > 0)
+            p.due = now;
+    }
+}
+
+void MHZ19Gateway::publish(byte index)
+{
+    MHZ19GatewayPort &p = this->port[index];
+    byte result = p.sensor.errorCode;
+    int ppm = 0;
+    int centi = 0;
+
+    if (result == RESULT_OK)
+    {
+        ppm = p.sensor.getCO2(true, false);
+        centi = p.sensor.getTemperatureCenti(false);
+        p.samples++;
+    }
+    else
+        p.failures++;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    this->ring->publish(index, result, ppm, centi, (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+unsigned long MHZ19Gateway::deadline(byte index)
+{
+    MHZ19GatewayPort &p = this->port[index];
+
+    return p.state == GATEWAY_PENDING ? p.sensor.nextDeadline() : p.due;
+}
@@ -0,0 +1,108 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+/*
+   Drives up to MHZ19GATEWAY_PORTS sensors on separate ttys from one epoll loop
+   (Linux), publishing every reading to shared memory (see MHZ19Shm.h).
+
+   Each port is an MHZ19 on a PosixSerial, stepped as a small state machine
+   with the library's own non-blocking calls: requestCO2() when a sample is due,
+   receive() when epoll reports bytes, and again at the reply's nextDeadline()
+   so time outs are noticed. The loop sleeps in epoll_wait() until the earliest
+   port deadline or arriving bytes, so ports never wait on each other.
+
+   Ports are verified with begin() as they are first opened, which blocks
+   briefly. A port which hangs up (adapter unplugged) is reopened every
+   MHZ19GATEWAY_RETRY ms with its saved identity, without communicating.
+*/
+
+#ifndef MHZ19_HOST_GATEWAY_H
+#define MHZ19_HOST_GATEWAY_H
+
+#include "Arduino.h"
+#include "MHZ19.h"
+#include "MHZ19Shm.h"
+#include "PosixSerial.h"
+
+#define MHZ19GATEWAY_PORTS 64			// Most ports, within MHZ19SHM_PORTS
+#define MHZ19GATEWAY_RETRY 1000			// Time between attempts to reopen a port (ms)
+#define MHZ19GATEWAY_EVENTS 64			// epoll events taken per wake
+
+/* enum alias for port states */
+enum GATEWAYSTATE
+{
+	GATEWAY_CLOSED = 0,					// Not open, retried at due
+	GATEWAY_IDLE = 1,					// Open, next request at due
+	GATEWAY_PENDING = 2					// Request sent, reply awaited
+};
+
+struct MHZ19GatewayPort
+{
+	const char *path;
+	PosixSerial serial;
+	MHZ19 sensor;
+	MHZ19Identity identity;
+	bool isIdentified;					// identity saved by a first begin()
+	byte state;							// GATEWAYSTATE value
+	unsigned long due;					// millis() of the next request or reopen
+	unsigned long samples;				// valid readings published
+	unsigned long failures;				// failed requests published
+};
+
+class MHZ19Gateway
+{
+  public:
+	~MHZ19Gateway() { end(); }
+
+	/*#####################-Initiation Functions-#####################*/
+
+	/* creates the epoll loop publishing to ring, requesting each port every interval ms (0 back to back) */
+	bool begin(MHZ19ShmWriter &ring, unsigned long interval = 5000);
+
+	/* adds and opens a tty, returns its port number (shared memory index) or -1 when full */
+	int addPort(const char *path);
+
+	void end();
+
+	/*######################-Utility Functions-########################*/
+
+	/* runs the loop for ms (0 until stop()) */
+	void run(unsigned long ms = 0);
+
+	/* ends run(), safe from a signal handler */
+	void stop() { this->isStopped = true; };
+
+	/*########################-Get Functions-##########################*/
+
+	byte getPorts() { return this->ports; };
+	MHZ19GatewayPort &getPort(byte port) { return this->port[port]; };
+
+	/* loop wake-ups, from epoll_wait() */
+	unsigned long getWakes() { return this->wakes; };
+
+  private:
+	/*###########################-Variables-##########################*/
+
+	MHZ19GatewayPort port[MHZ19GATEWAY_PORTS];
+	byte ports = 0;
+
+	MHZ19ShmWriter *ring = NULL;
+	unsigned long interval = 5000;
+	int epoll = -1;
+	volatile bool isStopped = false;
+	unsigned long wakes = 0;
+
+	/*######################-Internal Functions-########################*/
+
+	/* opens a port's tty and watches it, false leaves it CLOSED */
+	bool open(byte index);
+
+	/* steps a port's state machine, isReadable when epoll reported bytes */
+	void step(byte index, bool isReadable);
+
+	/* publishes a finished request */
+	void publish(byte index);
+
+	/* millis() when the port next needs stepping */
+	unsigned long deadline(byte index);
+};
+#endif
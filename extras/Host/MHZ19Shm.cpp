@@ -0,0 +1,256 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#include "MHZ19Shm.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static size_t segmentSize(uint32_t slots)
+{
+    return sizeof(MHZ19ShmHeader) + (size_t)(slots - 1) * sizeof(MHZ19ShmSlot);
+}
+
+/*########################-Writer-##########################*/
+
+bool MHZ19ShmWriter::begin(const char *name, uint32_t slots)
+{
+    end();
+
+    /* indexes map to slots with a mask */
+    if (!slots || (slots & (slots - 1)) || strlen(name) >= sizeof(this->name))
+    {
+        errno = EINVAL;
+        return false;
+    }
+
+    /* a segment left by a writer which died is replaced, its readers keep their mapping */
+    shm_unlink(name);
+
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+
+    if (fd < 0)
+        return false;
+
+    size_t size = segmentSize(slots);
+    void *memory = MAP_FAILED;
+
+    /* a new segment reads as zeros, every sequence 0 (never written) */
+    if (ftruncate(fd, size) == 0)
+        memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    int error = errno;
+    close(fd);
+
+    if (memory == MAP_FAILED)
+    {
+        shm_unlink(name);
+        errno = error;
+        return false;
+    }
+
+    this->header = (MHZ19ShmHeader *)memory;
+    this->size = size;
+    strcpy(this->name, name);
+    memset(this->counts, 0, sizeof(this->counts));
+
+    this->header->version = MHZ19SHM_VERSION;
+    this->header->slots = slots;
+    this->header->ports = MHZ19SHM_PORTS;
+
+    /* readers check the magic last */
+    std::atomic_thread_fence(std::memory_order_release);
+    this->header->magic = MHZ19SHM_MAGIC;
+
+    return true;
+}
+
+void MHZ19ShmWriter::end()
+{
+    if (!this->header)
+        return;
+
+    this->header->isClosed.store(1, std::memory_order_release);
+
+    munmap(this->header, this->size);
+    shm_unlink(this->name);
+
+    this->header = NULL;
+}
+
+void MHZ19ShmWriter::publish(uint8_t port, uint8_t result, int ppm, int centi, uint64_t time)
+{
+    if (!this->header || port >= MHZ19SHM_PORTS)
+        return;
+
+    uint16_t count = this->counts[port]++;
+
+    uint64_t value = (uint64_t)(uint16_t)ppm | (uint64_t)(uint16_t)centi << 16
+                     | (uint64_t)port << 32 | (uint64_t)result << 40 | (uint64_t)count << 48;
+
+    /* only this writer moves head, so it needs no read-modify-write */
+    uint64_t index = this->header->head.load(std::memory_order_relaxed);
+    MHZ19ShmSlot &latest = this->header->latest[port];
+
+    store(this->header->ring[index & (this->header->slots - 1)], 2 * (index + 1), time, value);
+    store(latest, latest.seq.load(std::memory_order_relaxed) + 2, time, value);
+
+    this->header->head.store(index + 1, std::memory_order_release);
+}
+
+void MHZ19ShmWriter::store(MHZ19ShmSlot &slot, uint64_t seq, uint64_t time, uint64_t value)
+{
+    /* odd while the fields are inconsistent */
+    slot.seq.store(seq - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.time.store(time, std::memory_order_relaxed);
+    slot.value.store(value, std::memory_order_relaxed);
+    slot.check.store(time ^ value ^ seq, std::memory_order_relaxed);
+
+    slot.seq.store(seq, std::memory_order_release);
+}
+
+/*########################-Reader-##########################*/
+
+bool MHZ19ShmReader::begin(const char *name)
+{
+    end();
+
+    int fd = shm_open(name, O_RDONLY, 0);
+
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    void *memory = MAP_FAILED;
+
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(MHZ19ShmHeader))
+        memory = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+    close(fd);
+
+    if (memory == MAP_FAILED)
+    {
+        errno = EINVAL;
+        return false;
+    }
+
+    const MHZ19ShmHeader *header = (const MHZ19ShmHeader *)memory;
+
+    if (header->magic != MHZ19SHM_MAGIC || header->version != MHZ19SHM_VERSION
+        || (size_t)st.st_size < segmentSize(header->slots))
+    {
+        munmap(memory, st.st_size);
+        errno = EINVAL;
+        return false;
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    this->header = header;
+    this->size = st.st_size;
+
+    uint64_t head = getHead();
+
+    this->cursor = head > header->slots ? head - header->slots : 0;
+    this->lost = 0;
+    this->torn = 0;
+
+    return true;
+}
+
+void MHZ19ShmReader::end()
+{
+    if (this->header)
+        munmap((void *)this->header, this->size);
+
+    this->header = NULL;
+}
+
+bool MHZ19ShmReader::next(MHZ19ShmSample &sample)
+{
+    uint64_t head = getHead();
+
+    while (this->cursor < head)
+    {
+        /* fell more than a ring behind, the oldest held is next */
+        if (head - this->cursor > this->header->slots)
+        {
+            this->lost += head - this->header->slots - this->cursor;
+            this->cursor = head - this->header->slots;
+        }
+
+        int loaded = load(this->header->ring[this->cursor & (this->header->slots - 1)], 2 * (this->cursor + 1), sample);
+
+        if (loaded == 0)
+            return false;
+
+        this->cursor++;
+
+        if (loaded > 0)
+            return true;
+
+        this->lost++;
+        head = getHead();
+    }
+
+    return false;
+}
+
+bool MHZ19ShmReader::getLatest(uint8_t port, MHZ19ShmSample &sample)
+{
+    if (port >= MHZ19SHM_PORTS)
+        return false;
+
+    return load(this->header->latest[port], 0, sample) > 0;
+}
+
+int MHZ19ShmReader::load(const MHZ19ShmSlot &slot, uint64_t seq, MHZ19ShmSample &sample)
+{
+    for (uint8_t attempt = 0; attempt < MHZ19SHM_RETRIES; attempt++)
+    {
+        uint64_t before = slot.seq.load(std::memory_order_acquire);
+
+        /* the writer has lapped this reader */
+        if (seq && before > seq)
+            return -1;
+
+        /* being written, which takes nanoseconds */
+        if (before & 1)
+            continue;
+
+        if (!before || (seq && before < seq))
+            return 0;
+
+        uint64_t time = slot.time.load(std::memory_order_relaxed);
+        uint64_t value = slot.value.load(std::memory_order_relaxed);
+        uint64_t check = slot.check.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (slot.seq.load(std::memory_order_relaxed) != before)
+            continue;
+
+        if (check != (time ^ value ^ before))
+        {
+            this->torn++;
+            return -1;
+        }
+
+        sample.index = before / 2 - 1;
+        sample.time = time;
+        sample.ppm = (int16_t)(value & 0xFFFF);
+        sample.centi = (int16_t)(value >> 16 & 0xFFFF);
+        sample.port = value >> 32 & 0xFF;
+        sample.result = value >> 40 & 0xFF;
+        sample.count = value >> 48;
+
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+/*
+   Readings published into POSIX shared memory (shm_open()) by one writer, e.g.
+   the gateway daemon, for any number of local reader processes. Readers map the
+   segment read-only and read samples in place, so there are no copies through the
+   kernel, no syscalls per sample, and a slow reader never holds up the writer.
+
+   Layout: a header, the latest sample of each port, then a ring of the last
+   slots samples in publish order. Every slot is a seqlock: its sequence is odd
+   while the writer is in it and 2 * (index + 1) once sample index is complete,
+   so a reader can tell a slot not yet written, being written, or overwritten
+   (lapped) from the one it wants, and retries or skips without locking.
+*/
+
+#ifndef MHZ19_HOST_SHM_H
+#define MHZ19_HOST_SHM_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MHZ19SHM_MAGIC 0x4D485A53UL		// "MHZS"
+#define MHZ19SHM_VERSION 1
+#define MHZ19SHM_PORTS 64				// Ports with a latest sample
+#define MHZ19SHM_SLOTS 4096				// Default ring length (power of two)
+#define MHZ19SHM_RETRIES 16				// Reads of a slot being written before giving up
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shared memory needs address free 64 bit atomics");
+
+/* a sample as readers see it */
+struct MHZ19ShmSample
+{
+	uint64_t index;						// publish order, from 0 (latest: updates of the port)
+	uint64_t time;						// CLOCK_REALTIME (us)
+	int16_t ppm;
+	int16_t centi;						// temperature (C * 100)
+	uint8_t port;
+	uint8_t result;						// ERRORCODE value
+	uint16_t count;						// samples of this port, wrapping, for spotting gaps
+};
+
+/* one seqlock slot, half a cache line */
+struct MHZ19ShmSlot
+{
+	std::atomic<uint64_t> seq;
+	std::atomic<uint64_t> time;
+	std::atomic<uint64_t> value;		// ppm, centi, port, result, count packed
+	std::atomic<uint64_t> check;		// time ^ value ^ seq, catches a torn read
+};
+
+struct MHZ19ShmHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t slots;
+	uint32_t ports;
+	std::atomic<uint32_t> isClosed;		// writer has stopped
+	uint32_t reserved[11];
+
+	alignas(64) std::atomic<uint64_t> head;	// samples published
+	uint64_t padding[7];
+
+	MHZ19ShmSlot latest[MHZ19SHM_PORTS];
+	MHZ19ShmSlot ring[1];				// slots long
+};
+
+class MHZ19ShmWriter
+{
+  public:
+	~MHZ19ShmWriter() { end(); }
+
+	/* creates (replacing) the segment, false with errno set if it cannot */
+	bool begin(const char *name, uint32_t slots = MHZ19SHM_SLOTS);
+
+	/* marks the segment closed for readers and removes its name */
+	void end();
+
+	/* publishes a sample to the ring and as the port's latest */
+	void publish(uint8_t port, uint8_t result, int ppm, int centi, uint64_t time);
+
+	uint64_t getHead() { return this->header ? this->header->head.load(std::memory_order_relaxed) : 0; };
+
+  private:
+	MHZ19ShmHeader *header = NULL;
+	size_t size = 0;
+	char name[64];
+	uint16_t counts[MHZ19SHM_PORTS];
+
+	static void store(MHZ19ShmSlot &slot, uint64_t seq, uint64_t time, uint64_t value);
+};
+
+class MHZ19ShmReader
+{
+  public:
+	~MHZ19ShmReader() { end(); }
+
+	/* maps an existing segment read-only, starting at its oldest held sample */
+	bool begin(const char *name);
+	void end();
+
+	/* takes the next sample in publish order, false when there is none yet */
+	bool next(MHZ19ShmSample &sample);
+
+	/* latest sample of a port, false if it has none */
+	bool getLatest(uint8_t port, MHZ19ShmSample &sample);
+
+	uint64_t getHead() { return this->header->head.load(std::memory_order_acquire); };
+	bool isClosed() { return this->header->isClosed.load(std::memory_order_acquire) != 0; };
+
+	/* samples overwritten before they were read */
+	uint64_t getLost() { return this->lost; };
+
+	/* reads failing their check despite a stable sequence, 0 unless the seqlock is broken */
+	uint64_t getTorn() { return this->torn; };
+
+  private:
+	const MHZ19ShmHeader *header = NULL;
+	size_t size = 0;
+	uint64_t cursor = 0;
+	uint64_t lost = 0;
+	uint64_t torn = 0;
+
+	/* reads a slot holding sequence seq, 1 done, 0 not there yet, -1 overwritten or torn */
+	int load(const MHZ19ShmSlot &slot, uint64_t seq, MHZ19ShmSample &sample);
+};
+#endif
@@ -0,0 +1,430 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#include "MHZ19Sim.h"
+
+#define DAY_MS 86400000ULL
+
+/*#####################-Initiation Functions-#####################*/
+
+void MHZ19Sim::begin(const char *version, int range, unsigned long seed)
+{
+    memcpy(this->version, version, 4);
+    this->range = range;
+    this->seed = seed ? seed : 1;
+
+    this->origin = hostMicros64();
+    this->modelTime = 0;
+    this->room = this->outdoor;
+    this->sensed = this->outdoor;
+    this->offset = 0;
+    this->ABCPeriod = 0xA0;
+
+    memset(this->lastReply, 0, sizeof(this->lastReply));
+    memset(this->commands, 0, sizeof(this->commands));
+    memset(this->faults, 0, sizeof(this->faults));
+    this->rejected = 0;
+
+    powerUp();
+}
+
+/*########################-Set Functions-##########################*/
+
+void MHZ19Sim::setRoom(int outdoor, int rise, byte occupiedFrom, byte occupiedTo, unsigned long tau)
+{
+    this->outdoor = outdoor;
+    this->rise = rise;
+    this->occupiedFrom = occupiedFrom;
+    this->occupiedTo = occupiedTo;
+    this->tau = tau ? tau : 1;
+    this->profile = NULL;
+}
+
+void MHZ19Sim::setDrift(int perDay, int noise)
+{
+    this->driftPerMs = (double)perDay / DAY_MS;
+    this->noise = noise;
+}
+
+void MHZ19Sim::setFaults(byte crc, byte timeout, byte garbage)
+{
+    this->rates[SIM_FAULT_CRC] = crc;
+    this->rates[SIM_FAULT_TIMEOUT] = timeout;
+    this->rates[SIM_FAULT_GARBAGE] = garbage;
+}
+
+/*########################-Get Functions-##########################*/
+
+int MHZ19Sim::getTrueCO2()
+{
+    advance();
+
+    return (int)(this->room + 0.5);
+}
+
+int MHZ19Sim::getReading()
+{
+    advance();
+
+    double reading = this->sensed + this->offset;
+
+    return reading < 0 ? 0 : (int)(reading + 0.5);
+}
+
+bool MHZ19Sim::isWarmingUp()
+{
+    advance();
+
+    return this->modelTime < this->warmEnd;
+}
+
+/*######################-Stream Functions-########################*/
+
+size_t MHZ19Sim::write(uint8_t c)
+{
+    /* the sensor waits for a start byte */
+    if (!this->requestCount && c != 0xFF)
+        return 1;
+
+    this->request[this->requestCount++] = c;
+
+    if (this->requestCount == MHZ19SIM_FRAME)
+    {
+        this->requestCount = 0;
+        respond();
+    }
+
+    return 1;
+}
+
+int MHZ19Sim::available()
+{
+    uint64_t now = hostMicros64();
+    int ready = 0;
+
+    /* queued in arrival order, so count up to the first still on the line */
+    while (ready < this->count && this->ready[(this->head + ready) % MHZ19SIM_QUEUE] <= now)
+        ready++;
+
+    return ready;
+}
+
+int MHZ19Sim::read()
+{
+    if (!available())
+        return -1;
+
+    byte c = this->queue[this->head];
+
+    this->head = (this->head + 1) % MHZ19SIM_QUEUE;
+    this->count--;
+
+    return c;
+}
+
+int MHZ19Sim::peek()
+{
+    return available() ? this->queue[this->head] : -1;
+}
+
+/*######################-Utility Functions-########################*/
+
+void MHZ19Sim::powerUp()
+{
+    advance();
+
+    this->powered = true;
+    this->bootEnd = this->modelTime;
+    this->warmEnd = this->modelTime + this->warmup;
+    this->ABCStart = this->modelTime;
+    this->ABCLowest = 1e9;
+    this->requestCount = 0;
+    this->head = 0;
+    this->count = 0;
+}
+
+void MHZ19Sim::setPower(bool isON)
+{
+    if (isON == this->powered)
+        return;
+
+    if (isON)
+    {
+        powerUp();
+        this->bootEnd = this->modelTime + MHZ19SIM_BOOT;
+        return;
+    }
+
+    advance();
+
+    this->powered = false;
+    this->requestCount = 0;
+    this->head = 0;
+    this->count = 0;
+}
+
+/*######################-Internal Functions-########################*/
+
+void MHZ19Sim::advance()
+{
+    uint64_t now = (hostMicros64() - this->origin) / 1000;
+
+    while (this->modelTime < now)
+    {
+        uint64_t dt = now - this->modelTime;
+
+        if (dt > MHZ19SIM_STEP)
+            dt = MHZ19SIM_STEP;
+
+        step(this->modelTime, (double)dt);
+        this->modelTime += dt;
+    }
+}
+
+void MHZ19Sim::step(uint64_t t, double dt)
+{
+    if (this->profile)
+        this->room = this->profile(t);
+    else
+    {
+        double target = roomTarget(t);
+        this->room = target + (this->room - target) * exp(-dt / this->tau);
+    }
+
+    this->sensed = this->room + (this->sensed - this->room) * exp(-dt / MHZ19SIM_RESPONSE);
+    this->offset += this->driftPerMs * dt;
+
+    if (!this->ABCPeriod)
+        return;
+
+    /* ABC takes the lowest reading of each cycle as 400ppm */
+    if (t >= this->warmEnd)
+    {
+        double reading = this->sensed + this->offset;
+
+        if (reading < this->ABCLowest)
+            this->ABCLowest = reading;
+    }
+
+    if (t + (uint64_t)dt - this->ABCStart >= MHZ19SIM_ABC_CYCLE)
+    {
+        if (this->ABCLowest < 1e9)
+            this->offset -= this->ABCLowest - 400;
+
+        this->ABCStart += MHZ19SIM_ABC_CYCLE;
+        this->ABCLowest = 1e9;
+    }
+}
+
+double MHZ19Sim::roomTarget(uint64_t t)
+{
+    byte hour = (t / 3600000ULL) % 24;
+
+    if (hour >= this->occupiedFrom && hour < this->occupiedTo)
+        return this->outdoor + this->rise;
+
+    return this->outdoor;
+}
+
+void MHZ19Sim::respond()
+{
+    byte command = this->request[2];
+
+    this->commands[command]++;
+
+    advance();
+
+    /* nothing answers without power, or while booting */
+    if (!this->powered || this->modelTime < this->bootEnd)
+        return;
+
+    /* requests with a bad checksum are ignored */
+    if (this->request[8] != CRC(this->request))
+    {
+        this->rejected++;
+        return;
+    }
+
+    bool isWarming = this->modelTime < this->warmEnd;
+    int reading = getReading() + jitter();
+
+    if (reading < 0)
+        reading = 0;
+
+    int limited = reading > this->range ? this->range : reading;
+    int unlimited = reading;
+
+    /* warm-up signature: limited holds 410, unlimited is abnormal */
+    if (isWarming)
+    {
+        limited = 410;
+        unlimited = 420 + (int)(4580ULL * (this->warmEnd - this->modelTime) / (this->warmup ? this->warmup : 1));
+    }
+
+    /* temperature swings 3C either side of 21C, warmest mid afternoon */
+    double hour = (double)(this->modelTime % DAY_MS) / 3600000.0;
+    int centi = 2100 + (int)(300 * sin((hour - 9) * M_PI / 12));
+
+    byte reply[MHZ19SIM_FRAME] = { 0xFF, command, 0, 0, 0, 0, 0, 0, 0 };
+
+    switch (command)
+    {
+    case 0x85:
+        reply[2] = centi >> 8;
+        reply[3] = centi & 0xFF;
+        reply[4] = unlimited >> 8;
+        reply[5] = unlimited & 0xFF;
+        break;
+    case 0x86:
+        reply[2] = limited >> 8;
+        reply[3] = limited & 0xFF;
+        reply[4] = centi / 100 + 40;
+        break;
+    case 0x84:
+    {
+        /* transmittance falls with CO2, 35000 at zero */
+        int raw = (int)(35000 * exp(-unlimited / 25000.0));
+        reply[2] = raw >> 8;
+        reply[3] = raw & 0xFF;
+        break;
+    }
+    case 0x9B:
+        reply[4] = this->range >> 8;
+        reply[5] = this->range & 0xFF;
+        break;
+    case 0x99:
+        this->range = (this->request[6] << 8) | this->request[7];
+        break;
+    case 0x9C:
+        reply[4] = 400 >> 8;
+        reply[5] = 400 & 0xFF;
+        break;
+    case 0xA0:
+        memcpy(&reply[2], this->version, 4);
+        break;
+    case 0xA2:
+        memcpy(&reply[2], &this->lastReply[2], 4);
+        break;
+    case 0xA3:
+        reply[3] = 40;
+        break;
+    case 0x7D:
+        reply[7] = this->ABCPeriod ? 1 : 0;
+        break;
+    case 0x79:
+        this->ABCPeriod = this->request[3];
+        this->ABCStart = this->modelTime;
+        this->ABCLowest = 1e9;
+        break;
+    case 0x87:
+        /* zero point, the current reading becomes 400ppm */
+        this->offset = 400 - this->sensed;
+        break;
+    case 0x78:
+        this->warmEnd = this->modelTime + this->warmup;
+        break;
+    default:
+        /* span (0x88) and others are acknowledged only */
+        break;
+    }
+
+    reply[8] = CRC(reply);
+
+    if (command == 0x85)
+        memcpy(this->lastReply, reply, MHZ19SIM_FRAME);
+
+    /* fault for this reply */
+    byte fault = this->nextFault;
+    this->nextFault = SIM_FAULT_NONE;
+
+    if (fault == SIM_FAULT_NONE)
+    {
+        unsigned long roll = percent();
+
+        for (byte f = SIM_FAULT_CRC; f <= SIM_FAULT_GARBAGE; f++)
+        {
+            if (roll < this->rates[f])
+            {
+                fault = f;
+                break;
+            }
+            roll -= this->rates[f];
+        }
+    }
+
+    this->faults[fault]++;
+
+    uint64_t at = hostMicros64() + MHZ19SIM_LATENCY;
+
+    switch (fault)
+    {
+    case SIM_FAULT_TIMEOUT:
+        return;
+    case SIM_FAULT_CRC:
+        reply[8] ^= 0x5A;
+        break;
+    case SIM_FAULT_GARBAGE:
+    {
+        byte garbage[4];
+        byte length = 1 + percent() % 4;
+
+        for (byte i = 0; i < length; i++)
+            garbage[i] = percent();
+
+        queueBytes(garbage, length, at);
+        at += (uint64_t)MHZ19SIM_BYTE * length;
+        break;
+    }
+    }
+
+    queueBytes(reply, MHZ19SIM_FRAME, at);
+}
+
+void MHZ19Sim::queueBytes(const byte *bytes, byte length, uint64_t at)
+{
+    /* the line cannot deliver faster than one byte time after the last queued */
+    if (this->count)
+    {
+        uint64_t last = this->ready[(this->head + this->count - 1) % MHZ19SIM_QUEUE];
+
+        if (at < last)
+            at = last;
+    }
+
+    for (byte i = 0; i < length && this->count < MHZ19SIM_QUEUE; i++)
+    {
+        byte slot = (this->head + this->count) % MHZ19SIM_QUEUE;
+
+        at += MHZ19SIM_BYTE;
+        this->queue[slot] = bytes[i];
+        this->ready[slot] = at;
+        this->count++;
+    }
+}
+
+unsigned long MHZ19Sim::percent()
+{
+    /* Park-Miller, reproducible across platforms */
+    this->seed = (unsigned long)((uint64_t)this->seed * 48271 % 2147483647);
+
+    return this->seed % 100;
+}
+
+int MHZ19Sim::jitter()
+{
+    if (!this->noise)
+        return 0;
+
+    this->seed = (unsigned long)((uint64_t)this->seed * 48271 % 2147483647);
+
+    return (int)(this->seed % (2 * this->noise + 1)) - this->noise;
+}
+
+byte MHZ19Sim::CRC(const byte bytes[])
+{
+    byte crc = 0;
+
+    for (byte x = 1; x < 8; x++)
+        crc += bytes[x];
+
+    return 255 - crc + 1;
+}
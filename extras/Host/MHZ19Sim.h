@@ -0,0 +1,185 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+/*
+   A simulated MH-Z19 for host programs, used as the Stream given to
+   MHZ19::begin(). It runs on the shim's clock (hostMicros64()), so with the
+   virtual clock days of operation replay in seconds.
+
+   Modelled: room CO2 (ventilated room with a daily occupancy schedule, or a
+   caller profile), the sensor's response lag, noise and baseline drift, ABC
+   correcting the baseline to 400ppm every 24 hours, zero calibration,
+   range, temperature, a switched supply (boot delay, no replies while OFF),
+   and the warm-up after power up or recovery reset where
+   limited CO2 (command 134) reads 410 while unlimited (133) is abnormal.
+   CRC, time out and garbage faults can be injected at a rate or one at a time.
+*/
+
+#ifndef MHZ19_HOST_SIM_H
+#define MHZ19_HOST_SIM_H
+
+#include "Arduino.h"
+
+#define MHZ19SIM_WARMUP 180000UL		// Warm-up after power up / reset (ms, 3 minutes per datasheet)
+#define MHZ19SIM_BOOT 1000				// Time after power up before requests are answered (ms)
+#define MHZ19SIM_LATENCY 10000			// Processing time before replying (us)
+#define MHZ19SIM_BYTE 1042				// One byte at 9600 baud (us)
+#define MHZ19SIM_ABC_CYCLE 86400000ULL	// ABC correction period (ms, 24 hours)
+#define MHZ19SIM_RESPONSE 52000			// Sensor response time constant (ms, T90 of 120s)
+#define MHZ19SIM_STEP 10000				// Longest model step (ms)
+#define MHZ19SIM_QUEUE 64				// Reply bytes which can be queued
+#define MHZ19SIM_FRAME 9				// Protocol frame length
+
+/* enum alias for injected faults */
+enum SIMFAULT
+{
+	SIM_FAULT_NONE = 0,
+	SIM_FAULT_CRC = 1,					// Reply with a corrupted checksum
+	SIM_FAULT_TIMEOUT = 2,				// No reply
+	SIM_FAULT_GARBAGE = 3				// Random bytes before the reply
+};
+
+class MHZ19Sim : public Stream
+{
+  public:
+	/*#####################-Initiation Functions-#####################*/
+
+	/* powers the sensor up now, version is the 4 character firmware version */
+	void begin(const char *version = "0443", int range = 2000, unsigned long seed = 1);
+
+	/*########################-Set Functions-##########################*/
+
+	/* ventilated room: CO2 settles to outdoor + rise while occupied (hours given), with time constant tau */
+	void setRoom(int outdoor = 420, int rise = 900, byte occupiedFrom = 8, byte occupiedTo = 18, unsigned long tau = 3600000UL);
+
+	/* replaces the room with a profile giving true ppm at a time (ms since begin()) */
+	void setProfile(int (*profile)(uint64_t ms)) { this->profile = profile; };
+
+	/* baseline drift (ppm per day, signed) and reading noise (+/- ppm) */
+	void setDrift(int perDay, int noise = 10);
+
+	/* percentages of replies given each fault */
+	void setFaults(byte crc, byte timeout, byte garbage);
+
+	/* warm-up after power up / reset (ms) */
+	void setWarmup(unsigned long warmup) { this->warmup = warmup; };
+
+	/* gives the next reply a fault */
+	void injectFault(byte fault) { this->nextFault = fault; };
+
+	/*########################-Get Functions-##########################*/
+
+	/* true CO2 in the room (ppm) */
+	int getTrueCO2();
+
+	/* what the sensor would report now, without noise (ppm) */
+	int getReading();
+
+	/* baseline offset added by drift and corrected by ABC / calibration (ppm) */
+	int getOffset() { return (int)this->offset; };
+
+	bool isWarmingUp();
+	bool isPowered() { return this->powered; };
+	bool getABC() { return this->ABCPeriod != 0; };
+	int getRange() { return this->range; };
+
+	/* number of requests received with a command byte, e.g. 0x79 */
+	unsigned long getCommandCount(byte command) { return this->commands[command]; };
+
+	/* faults given, by SIMFAULT value */
+	unsigned long getFaultCount(byte fault) { return fault <= SIM_FAULT_GARBAGE ? this->faults[fault] : 0; };
+
+	/* requests ignored for a bad checksum */
+	unsigned long getRejected() { return this->rejected; };
+
+	/*######################-Stream Functions-########################*/
+
+	size_t write(uint8_t c);
+	using Print::write;
+
+	int available();
+	int read();
+	int peek();
+
+	/*######################-Utility Functions-########################*/
+
+	/* power cycle, as after a brown out */
+	void powerUp();
+
+	/* switches the supply, requests are ignored while OFF and during boot (see MHZ19SIM_BOOT) */
+	void setPower(bool isON);
+
+  private:
+	/*###########################-Variables-##########################*/
+
+	char version[4];
+	int range = 2000;
+	byte ABCPeriod = 0xA0;					// ABC byte written, 0 when OFF (ON from the factory)
+
+	/* room */
+	int outdoor = 420;
+	int rise = 900;
+	byte occupiedFrom = 8;
+	byte occupiedTo = 18;
+	unsigned long tau = 3600000UL;
+	int (*profile)(uint64_t ms) = NULL;
+
+	/* model state, advanced lazily to the clock (see MHZ19SIM_STEP) */
+	uint64_t origin = 0;					// hostMicros64() at begin() (us)
+	uint64_t modelTime = 0;					// ms since begin() the model has reached
+	double room = 420;						// room CO2
+	double sensed = 420;					// CO2 at the sensor's cell, lagging room
+	double offset = 0;						// baseline error
+	double driftPerMs = 0;
+	int noise = 10;
+	uint64_t warmEnd = 0;					// ms since begin() when warm-up ends
+	uint64_t bootEnd = 0;					// ms since begin() when requests are answered
+	unsigned long warmup = MHZ19SIM_WARMUP;
+	bool powered = true;
+	uint64_t ABCStart = 0;					// ms since begin() when the current ABC cycle began
+	double ABCLowest = 1e9;					// lowest reading in the current ABC cycle
+
+	/* link */
+	byte request[MHZ19SIM_FRAME];
+	byte requestCount = 0;
+	byte lastReply[MHZ19SIM_FRAME];			// last command 133 reply, for command 162
+	byte queue[MHZ19SIM_QUEUE];
+	uint64_t ready[MHZ19SIM_QUEUE];		// hostMicros64() when each queued byte arrives
+	byte head = 0;
+	byte count = 0;
+
+	/* faults */
+	byte rates[SIM_FAULT_GARBAGE + 1] = { 0 };
+	byte nextFault = SIM_FAULT_NONE;
+	unsigned long seed = 1;
+
+	/* statistics */
+	unsigned long commands[256];
+	unsigned long faults[SIM_FAULT_GARBAGE + 1];
+	unsigned long rejected = 0;
+
+	/*######################-Internal Functions-########################*/
+
+	/* advances the model to the clock */
+	void advance();
+
+	/* one model step of dt ms at time t */
+	void step(uint64_t t, double dt);
+
+	/* room CO2 the room is heading for at time t */
+	double roomTarget(uint64_t t);
+
+	/* answers a complete request */
+	void respond();
+
+	/* queues bytes to arrive from 'at' (us), one byte time apart */
+	void queueBytes(const byte *bytes, byte length, uint64_t at);
+
+	/* 0 - 99, deterministic per seed */
+	unsigned long percent();
+
+	/* signed noise within +/- noise */
+	int jitter();
+
+	static byte CRC(const byte bytes[]);
+};
+#endif
@@ -0,0 +1,380 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#include "MHZ19Trace.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*########################-Check Kernels-##########################*/
+
+static size_t checkScalar(const uint8_t *records, size_t count, uint64_t *valid)
+{
+    size_t total = 0;
+
+    for (size_t i = 0; i < count; i += 64)
+    {
+        size_t end = count - i < 64 ? count - i : 64;
+        uint64_t bits = 0;
+
+        for (size_t j = 0; j < end; j++)
+        {
+            const uint8_t *frame = records + (i + j) * MHZ19TRACE_RECORD + MHZ19TRACE_FRAME;
+            uint8_t sum = 0;
+
+            for (uint8_t x = 1; x < 9; x++)
+                sum += frame[x];
+
+            if (frame[0] == 0xFF && !sum)
+                bits |= (uint64_t)1 << j;
+        }
+
+        valid[i / 64] = bits;
+        total += __builtin_popcountll(bits);
+    }
+
+    return total;
+}
+
+#if defined(__SSE2__)
+static size_t checkSSE2(const uint8_t *records, size_t count, uint64_t *valid)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i start = _mm_set1_epi8((char)0xFF);
+    const __m128i byteMask = _mm_set1_epi16(0xFF);
+    size_t total = 0;
+
+    for (size_t i = 0; i < count; i += 64)
+    {
+        size_t end = count - i < 64 ? count - i : 64;
+        const uint8_t *base = records + i * MHZ19TRACE_RECORD;
+        uint64_t bits = 0;
+
+        size_t j = 0;
+
+        /* four records a step */
+        for (; j + 4 <= end; j += 4)
+        {
+            const __m128i *in = (const __m128i *)(base + j * MHZ19TRACE_RECORD);
+            __m128i r0 = _mm_loadu_si128(in);
+            __m128i r1 = _mm_loadu_si128(in + 1);
+            __m128i r2 = _mm_loadu_si128(in + 2);
+            __m128i r3 = _mm_loadu_si128(in + 3);
+
+            /* upper lanes sum bytes 8 - 15, frame bytes 1 - 8, packed to 16 bit words 0, 2, 4, 6 */
+            __m128i sums = _mm_packs_epi32(_mm_unpackhi_epi64(_mm_sad_epu8(r0, zero), _mm_sad_epu8(r1, zero)),
+                                           _mm_unpackhi_epi64(_mm_sad_epu8(r2, zero), _mm_sad_epu8(r3, zero)));
+            uint32_t sumOK = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(sums, byteMask), zero));
+
+            /* start bytes, byte 7 of each lower half, at mask bits 7 and 15 */
+            uint32_t start01 = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_unpacklo_epi64(r0, r1), start));
+            uint32_t start23 = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_unpacklo_epi64(r2, r3), start));
+
+            uint32_t good = ((sumOK & start01 << 0 >> 7) & 1)
+                            | ((sumOK >> 4 & start01 >> 15) & 1) << 1
+                            | ((sumOK >> 8 & start23 >> 7) & 1) << 2
+                            | ((sumOK >> 12 & start23 >> 15) & 1) << 3;
+
+            bits |= (uint64_t)good << j;
+        }
+
+        for (; j < end; j++)
+        {
+            __m128i record = _mm_loadu_si128((const __m128i *)(base + j * MHZ19TRACE_RECORD));
+            uint32_t sum = (uint32_t)_mm_extract_epi16(_mm_sad_epu8(record, zero), 4);
+            uint32_t isStart = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(record, start)) >> 7 & 1;
+
+            bits |= (uint64_t)(isStart & !(sum & 0xFF)) << j;
+        }
+
+        valid[i / 64] = bits;
+        total += __builtin_popcountll(bits);
+    }
+
+    return total;
+}
+#endif
+
+size_t mhz19TraceCheck(const uint8_t *records, size_t count, uint64_t *valid, bool isScalar)
+{
+#if defined(__SSE2__)
+    if (!isScalar)
+        return checkSSE2(records, count, valid);
+#endif
+    (void)isScalar;
+
+    return checkScalar(records, count, valid);
+}
+
+/*########################-Get Functions-##########################*/
+
+const MHZ19TraceUnit *MHZ19TraceStats::getUnit(size_t unit)
+{
+    if (unit >= this->units.size() || !this->units[unit].seen)
+        return NULL;
+
+    return &this->units[unit];
+}
+
+MHZ19TraceUnit MHZ19TraceStats::getTotal()
+{
+    MHZ19TraceUnit total;
+
+    memset(&total, 0, sizeof(total));
+    total.latencyMin = UINT32_MAX;
+
+    for (size_t i = 0; i < this->units.size(); i++)
+    {
+        const MHZ19TraceUnit &unit = this->units[i];
+
+        total.requests += unit.requests;
+        total.replies += unit.replies;
+        total.crc += unit.crc;
+        total.framing += unit.framing;
+        total.mismatch += unit.mismatch;
+        total.unanswered += unit.unanswered;
+        total.latencyTotal += unit.latencyTotal;
+
+        if (unit.replies && unit.latencyMin < total.latencyMin)
+            total.latencyMin = unit.latencyMin;
+
+        if (unit.latencyMax > total.latencyMax)
+            total.latencyMax = unit.latencyMax;
+    }
+
+    return total;
+}
+
+/*######################-Utility Functions-########################*/
+
+void MHZ19TraceStats::add(const uint8_t *records, size_t count)
+{
+    uint64_t valid[MHZ19TRACE_BATCH / 64];
+
+    for (size_t i = 0; i < count; i += MHZ19TRACE_BATCH)
+    {
+        size_t batch = count - i < MHZ19TRACE_BATCH ? count - i : MHZ19TRACE_BATCH;
+        const uint8_t *base = records + i * MHZ19TRACE_RECORD;
+
+        mhz19TraceCheck(base, batch, valid, this->isScalar);
+
+        for (size_t j = 0; j < batch; j++)
+            record(base + j * MHZ19TRACE_RECORD, valid[j / 64] >> (j % 64) & 1);
+    }
+
+    this->records += count;
+}
+
+bool MHZ19TraceStats::addFile(const char *path)
+{
+    if (!strcmp(path, "-"))
+    {
+        static uint8_t block[1 << 20];
+        ssize_t length;
+
+        while ((length = read(STDIN_FILENO, block, sizeof(block))) > 0)
+            addBytes(block, (size_t)length);
+
+        return length == 0;
+    }
+
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+
+    if (fstat(fd, &info) < 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    size_t size = (size_t)info.st_size;
+
+    if (size < MHZ19TRACE_RECORD)
+    {
+        close(fd);
+        return true;
+    }
+
+    void *mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapped == MAP_FAILED)
+        return false;
+
+    madvise(mapped, size, MADV_SEQUENTIAL);
+
+    add((const uint8_t *)mapped, size / MHZ19TRACE_RECORD);
+
+    munmap(mapped, size);
+
+    return true;
+}
+
+void MHZ19TraceStats::finish()
+{
+    for (size_t i = 0; i < this->units.size(); i++)
+    {
+        if (this->units[i].pending)
+        {
+            this->units[i].unanswered++;
+            this->units[i].pending = false;
+        }
+    }
+}
+
+void MHZ19TraceStats::print(FILE *out, bool isErrorsOnly)
+{
+    fprintf(out, "%-8s %10s %10s %7s %7s %7s %7s %7s %8s %8s %8s\n", "unit", "requests", "replies",
+            "crc", "framing", "match", "lost", "error%", "min us", "avg us", "max us");
+
+    char label[24];
+
+    for (size_t i = 0; i < this->units.size(); i++)
+    {
+        const MHZ19TraceUnit &unit = this->units[i];
+
+        if (!unit.seen)
+            continue;
+
+        if (isErrorsOnly && !(unit.crc + unit.framing + unit.mismatch + unit.unanswered))
+            continue;
+
+        snprintf(label, sizeof(label), "%zu", i);
+        printUnit(out, label, unit);
+    }
+
+    printUnit(out, "total", getTotal());
+}
+
+/*######################-Internal Functions-########################*/
+
+void MHZ19TraceStats::record(const uint8_t *record, bool isValid)
+{
+    uint32_t time = record[0] | record[1] << 8 | record[2] << 16 | (uint32_t)record[3] << 24;
+    uint16_t number = record[4] | record[5] << 8;
+    uint8_t direction = record[6];
+    const uint8_t *frame = record + MHZ19TRACE_FRAME;
+
+    if (number >= this->units.size())
+    {
+        MHZ19TraceUnit empty;
+
+        memset(&empty, 0, sizeof(empty));
+        empty.latencyMin = UINT32_MAX;
+
+        this->units.resize((size_t)number + 1, empty);
+    }
+
+    MHZ19TraceUnit &unit = this->units[number];
+    unit.seen = true;
+
+    /* a reply late beyond the time out was given up on by the library */
+    if (unit.pending && time - unit.pendingTime > MHZ19TRACE_TIMEOUT)
+    {
+        unit.unanswered++;
+        unit.pending = false;
+    }
+
+    if (!isValid)
+    {
+        if (direction == MHZ19TRACE_TX)
+            unit.requests++;
+
+        if (frame[0] != 0xFF)
+            unit.framing++;
+        else
+            unit.crc++;
+
+        /* the damaged frame was the reply, counted once rather than again as unanswered */
+        if (direction == MHZ19TRACE_RX)
+            unit.pending = false;
+
+        return;
+    }
+
+    if (direction == MHZ19TRACE_TX)
+    {
+        if (unit.pending)
+            unit.unanswered++;
+
+        unit.requests++;
+        unit.pending = true;
+        unit.pendingTime = time;
+        unit.pendingCommand = frame[2];
+        return;
+    }
+
+    /* the library ends the request with RESULT_MATCH, so it is not also unanswered */
+    if (!unit.pending || frame[1] != unit.pendingCommand)
+    {
+        unit.mismatch++;
+        unit.pending = false;
+        return;
+    }
+
+    uint32_t latency = time - unit.pendingTime;
+
+    unit.pending = false;
+    unit.replies++;
+    unit.latencyTotal += latency;
+
+    if (latency < unit.latencyMin)
+        unit.latencyMin = latency;
+
+    if (latency > unit.latencyMax)
+        unit.latencyMax = latency;
+}
+
+void MHZ19TraceStats::addBytes(const uint8_t *bytes, size_t length)
+{
+    /* complete a record split across reads */
+    if (this->carried)
+    {
+        size_t take = MHZ19TRACE_RECORD - this->carried;
+
+        if (take > length)
+            take = length;
+
+        memcpy(this->carry + this->carried, bytes, take);
+        this->carried += take;
+        bytes += take;
+        length -= take;
+
+        if (this->carried < MHZ19TRACE_RECORD)
+            return;
+
+        add(this->carry, 1);
+        this->carried = 0;
+    }
+
+    size_t whole = length / MHZ19TRACE_RECORD;
+
+    add(bytes, whole);
+
+    this->carried = length - whole * MHZ19TRACE_RECORD;
+    memcpy(this->carry, bytes + whole * MHZ19TRACE_RECORD, this->carried);
+}
+
+void MHZ19TraceStats::printUnit(FILE *out, const char *label, const MHZ19TraceUnit &unit)
+{
+    uint64_t errors = unit.crc + unit.framing + unit.mismatch + unit.unanswered;
+    double rate = unit.requests ? 100.0 * errors / unit.requests : 0;
+
+    fprintf(out, "%-8s %10llu %10llu %7llu %7llu %7llu %7llu %7.2f %8lu %8llu %8lu\n", label,
+            (unsigned long long)unit.requests, (unsigned long long)unit.replies,
+            (unsigned long long)unit.crc, (unsigned long long)unit.framing,
+            (unsigned long long)unit.mismatch, (unsigned long long)unit.unanswered, rate,
+            (unsigned long)(unit.replies ? unit.latencyMin : 0),
+            (unsigned long long)(unit.replies ? unit.latencyTotal / unit.replies : 0),
+            (unsigned long)unit.latencyMax);
+}
@@ -0,0 +1,116 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+/*
+   Reads captured UART traces of MH-Z19 traffic on a host, in bulk.
+
+   A trace is a sequence of 16 byte records, little endian:
+
+     offset  0  time (us, 32 bit, wraps)
+             4  unit (16 bit, the field unit / port captured)
+             6  direction (MHZ19TRACE_TX host to sensor, MHZ19TRACE_RX sensor to host)
+             7  the 9 byte frame
+
+   Frame bytes 1 - 8 fill the upper half of the record, so the checksum test
+   (bytes 1 - 8 summing to 0 mod 256) is one SSE2 sum of absolute differences
+   per record. Records are checked in batches into a bit per record, then the
+   per-unit pass matches replies to requests for error rates and latency.
+   Files are memory-mapped, pipes ("-") are read in blocks.
+*/
+
+#ifndef MHZ19_HOST_TRACE_H
+#define MHZ19_HOST_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+#define MHZ19TRACE_RECORD 16			// Record length (bytes)
+#define MHZ19TRACE_FRAME 7				// Offset of the frame in a record
+#define MHZ19TRACE_TX 0					// Host to sensor
+#define MHZ19TRACE_RX 1					// Sensor to host
+#define MHZ19TRACE_BATCH 4096			// Records checked per kernel call (multiple of 64)
+#define MHZ19TRACE_TIMEOUT 500000UL		// Replies later than this count as unanswered (us, the library's TIMEOUT_PERIOD)
+
+/* per unit summary, see MHZ19TraceStats::getUnit() */
+struct MHZ19TraceUnit
+{
+	uint64_t requests;
+	uint64_t replies;					// valid replies matched to a request
+	uint64_t crc;						// frames failing the checksum
+	uint64_t framing;					// frames without the 0xFF start byte
+	uint64_t mismatch;					// valid replies not answering the request (or unrequested)
+	uint64_t unanswered;				// requests without a reply within MHZ19TRACE_TIMEOUT
+	uint64_t latencyTotal;				// us, over matched replies
+	uint32_t latencyMin;
+	uint32_t latencyMax;
+
+	/* state while reading */
+	uint32_t pendingTime;
+	uint8_t pendingCommand;
+	bool pending;
+	bool seen;
+};
+
+/* start byte and checksum of count records, a bit per valid record in valid[] (bit i % 64 of word i / 64).
+ * Returns the number valid. isScalar forces the portable kernel
+ */
+size_t mhz19TraceCheck(const uint8_t *records, size_t count, uint64_t *valid, bool isScalar = false);
+
+class MHZ19TraceStats
+{
+  public:
+	/*########################-Set Functions-##########################*/
+
+	/* uses the byte at a time kernel, for comparison */
+	void setScalar(bool isScalar) { this->isScalar = isScalar; };
+
+	/*########################-Get Functions-##########################*/
+
+	/* highest unit number seen + 1 */
+	size_t getUnits() { return this->units.size(); };
+
+	/* summary of one unit, NULL if never seen */
+	const MHZ19TraceUnit *getUnit(size_t unit);
+
+	/* all units added together */
+	MHZ19TraceUnit getTotal();
+
+	uint64_t getRecords() { return this->records; };
+
+	/*######################-Utility Functions-########################*/
+
+	/* reads count whole records */
+	void add(const uint8_t *records, size_t count);
+
+	/* reads a file through mmap(), or standard input for "-". Returns false if it cannot be read */
+	bool addFile(const char *path);
+
+	/* ends requests still awaiting a reply as unanswered, call after the last add() */
+	void finish();
+
+	/* prints units (all, or only those with errors) and the total */
+	void print(FILE *out, bool isErrorsOnly = false);
+
+  private:
+	/*###########################-Variables-##########################*/
+
+	std::vector<MHZ19TraceUnit> units;
+	uint64_t records = 0;
+	bool isScalar = false;
+
+	/* a partial record carried between reads from a pipe */
+	uint8_t carry[MHZ19TRACE_RECORD];
+	size_t carried = 0;
+
+	/*######################-Internal Functions-########################*/
+
+	/* one record, valid as found by the kernel */
+	void record(const uint8_t *record, bool isValid);
+
+	/* reads bytes from a pipe, records may span reads */
+	void addBytes(const uint8_t *bytes, size_t length);
+
+	static void printUnit(FILE *out, const char *label, const MHZ19TraceUnit &unit);
+};
+#endif
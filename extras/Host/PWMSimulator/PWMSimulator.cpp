@@ -0,0 +1,166 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+/*
+   Host tool: drives MHZ19PWM with simulated PWM pulses on a virtual clock.
+
+   Several sensors are simulated on separate pins, each following its own
+   CO2 profile with timing jitter and the occasional glitch (a truncated
+   cycle). Decoded ppm is compared with the simulated value, and the program
+   exits non-zero if any reading is wrong or a glitch was accepted.
+
+   Build (from this folder):
+     g++ -std=gnu++11 -O2 -I.. -I../../../src -o PWMSimulator PWMSimulator.cpp ../Arduino.cpp ../../../src/MHZ19*.cpp
+*/
+
+#include <Arduino.h>
+#include "MHZ19PWM.h"
+
+#define SENSORS 4
+#define CYCLES 600
+
+struct PulseSensor
+{
+    byte pin;
+    int range;
+    int ppm;                    // value encoded in the current cycle
+    uint64_t nextEdge;          // virtual time of the next edge (us)
+    bool level;                 // level after the next edge
+    uint64_t fallAt;            // fall time within the current cycle
+    uint64_t cycleEnd;          // next rising edge
+    bool isGlitch;              // current cycle is deliberately truncated
+    MHZ19PWM reader;
+};
+
+static PulseSensor sensors[SENSORS];
+static long checked = 0, failed = 0, glitches = 0, glitchesAccepted = 0;
+
+/* ppm follows a slow triangle wave between 400 and range, plus a per sensor phase */
+static int profile(byte index, long cycle)
+{
+    long span = sensors[index].range - 400;
+    long phase = (cycle * 7 + index * 53) % 200;
+    long tri = phase < 100 ? phase : 200 - phase;
+
+    return (int)(400 + span * tri / 100);
+}
+
+/* schedules one cycle starting at 'start', datasheet: TH = 2ms + 1000ms * ppm / range */
+static void startCycle(byte index, uint64_t start, long cycle)
+{
+    PulseSensor &s = sensors[index];
+
+    long jitter = (rand() % 2001) - 1000;      // +/- 1ms on the cycle
+
+    s.ppm = profile(index, cycle);
+    uint64_t high = 2000 + (uint64_t)1000000 * s.ppm / s.range;
+    s.isGlitch = (rand() % 50) == 0;
+
+    s.fallAt = start + high;
+    s.cycleEnd = start + (MHZ19_PWM_CYCLE * 1000) + jitter;
+
+    if (s.isGlitch)
+        s.cycleEnd = start + (MHZ19_PWM_CYCLE * 1000) / 2;
+
+    s.nextEdge = s.fallAt;
+    s.level = LOW;
+}
+
+int main()
+{
+    hostUseVirtualClock();
+    srand(19);
+
+    long cycles[SENSORS] = { 0 };
+    const int ranges[SENSORS] = { 2000, 5000, 10000, 2000 };
+
+    for (byte i = 0; i < SENSORS; i++)
+    {
+        sensors[i].pin = 2 + i;
+        sensors[i].range = ranges[i];
+
+        if (sensors[i].reader.begin(sensors[i].pin, sensors[i].range))
+        {
+            printf("PWMSimulator: failed to attach reader %d\n", i);
+            return 1;
+        }
+
+        /* staggered start, first edge is a rising edge */
+        sensors[i].nextEdge = micros() + 1000 + i * 137000;
+        sensors[i].level = HIGH;
+        sensors[i].cycleEnd = sensors[i].nextEdge;
+    }
+
+    int expected[SENSORS] = { 0 };
+    bool expectedValid[SENSORS] = { false };
+
+    for (;;)
+    {
+        /* next edge across all sensors */
+        byte index = 0;
+        for (byte i = 1; i < SENSORS; i++)
+            if (sensors[i].nextEdge < sensors[index].nextEdge)
+                index = i;
+
+        PulseSensor &s = sensors[index];
+
+        if (cycles[index] >= CYCLES)
+            break;
+
+        hostAdvanceMicros(s.nextEdge - hostMicros64());
+
+        if (s.level == HIGH)
+        {
+            /* rising edge closes the previous cycle */
+            hostPinWrite(s.pin, HIGH);
+
+            if (cycles[index] > 0)
+            {
+                bool wasGlitch = s.isGlitch;
+
+                if (s.reader.available())
+                {
+                    int ppm = s.reader.getCO2();
+
+                    if (wasGlitch)
+                        glitchesAccepted++;
+                    else
+                    {
+                        checked++;
+                        if (abs(ppm - expected[index]) > s.range / 1000 + 1)
+                        {
+                            failed++;
+                            printf("sensor %d cycle %ld: decoded %d, simulated %d\n", index, cycles[index], ppm, expected[index]);
+                        }
+                    }
+                }
+                else if (!wasGlitch && expectedValid[index])
+                {
+                    failed++;
+                    printf("sensor %d cycle %ld: cycle not decoded\n", index, cycles[index]);
+                }
+
+                if (wasGlitch)
+                    glitches++;
+            }
+
+            startCycle(index, s.nextEdge, cycles[index]++);
+            expected[index] = s.ppm;
+            expectedValid[index] = true;
+        }
+        else
+        {
+            hostPinWrite(s.pin, LOW);
+            s.nextEdge = s.cycleEnd;
+            s.level = HIGH;
+        }
+    }
+
+    printf("PWMSimulator: %d sensors, %ld cycles decoded, %ld failed, %ld glitches (%ld accepted)\n",
+           SENSORS, checked, failed, glitches, glitchesAccepted);
+
+    for (byte i = 0; i < SENSORS; i++)
+        printf("  pin %d range %5d: last %5d ppm, status %d\n", sensors[i].pin, sensors[i].range,
+               sensors[i].reader.getCO2(), sensors[i].reader.getStatus());
+
+    return (failed || glitchesAccepted) ? 1 : 0;
+}
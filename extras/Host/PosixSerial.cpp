@@ -0,0 +1,215 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#include "PosixSerial.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+/*#####################-Initiation Functions-#####################*/
+
+bool PosixSerial::begin(const char *path, unsigned long baudrate)
+{
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+    if (fd < 0)
+        return false;
+
+    return begin(fd, baudrate);
+}
+
+bool PosixSerial::begin(int fd, unsigned long baudrate)
+{
+    speed_t speed;
+
+    switch (baudrate)
+    {
+    case 1200: speed = B1200; break;
+    case 2400: speed = B2400; break;
+    case 4800: speed = B4800; break;
+    case 9600: speed = B9600; break;
+    case 19200: speed = B19200; break;
+    case 38400: speed = B38400; break;
+    case 57600: speed = B57600; break;
+    case 115200: speed = B115200; break;
+    default:
+        close(fd);
+        errno = EINVAL;
+        return false;
+    }
+
+    struct termios tio;
+
+    if (tcgetattr(fd, &tio) < 0)
+    {
+        int error = errno;
+        close(fd);
+        errno = error;
+        return false;
+    }
+
+    /* raw 8N1, no flow control, reads return what is there */
+    cfmakeraw(&tio);
+    tio.c_cflag &= ~(PARENB | CSTOPB | CSIZE | CRTSCTS);
+    tio.c_cflag |= CS8 | CLOCAL | CREAD;
+    tio.c_iflag &= ~(IXON | IXOFF | IXANY);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+
+    if (tcsetattr(fd, TCSANOW, &tio) < 0 || fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) < 0)
+    {
+        int error = errno;
+        close(fd);
+        errno = error;
+        return false;
+    }
+
+    /* bytes from before the port was opened belong to no request */
+    tcflush(fd, TCIOFLUSH);
+
+    end();
+    this->fd = fd;
+
+    return true;
+}
+
+void PosixSerial::end()
+{
+    if (this->fd >= 0)
+        close(this->fd);
+
+    this->fd = -1;
+    this->head = 0;
+    this->count = 0;
+    this->lastAvailable = -1;
+}
+
+/*######################-Stream Functions-########################*/
+
+size_t PosixSerial::write(const uint8_t *buffer, size_t size)
+{
+    size_t written = 0;
+
+    this->lastAvailable = -1;
+
+    while (written < size && this->fd >= 0)
+    {
+        ssize_t n = ::write(this->fd, buffer + written, size - written);
+
+        if (n > 0)
+            written += n;
+        else if (n < 0 && errno == EAGAIN)
+        {
+            /* transmit queue full, wait for room rather than spin */
+            struct pollfd p = { this->fd, POLLOUT, 0 };
+
+            if (poll(&p, 1, POSIXSERIAL_WRITE) <= 0)
+                break;
+        }
+        else if (n < 0 && errno != EINTR)
+            break;
+    }
+
+    return written;
+}
+
+void PosixSerial::flush()
+{
+    if (this->fd >= 0)
+        tcdrain(this->fd);
+}
+
+int PosixSerial::available()
+{
+    fill();
+
+    /* asked again with nothing new, so the caller is waiting for bytes */
+    if ((int)this->count == this->lastAvailable && this->wait > 0)
+    {
+        waitReadable(this->wait);
+        fill();
+    }
+
+    this->lastAvailable = this->count;
+
+    return this->count;
+}
+
+int PosixSerial::read()
+{
+    if (!this->count)
+        fill();
+
+    if (!this->count)
+        return -1;
+
+    uint8_t c = this->fifo[this->head];
+
+    this->head = (this->head + 1) % POSIXSERIAL_BUFFER;
+    this->count--;
+    this->lastAvailable = -1;
+
+    return c;
+}
+
+int PosixSerial::peek()
+{
+    if (!this->count)
+        fill();
+
+    return this->count ? this->fifo[this->head] : -1;
+}
+
+/*######################-Internal Functions-########################*/
+
+void PosixSerial::fill()
+{
+    while (this->fd >= 0 && this->count < POSIXSERIAL_BUFFER)
+    {
+        /* contiguous free space after the tail */
+        size_t tail = (this->head + this->count) % POSIXSERIAL_BUFFER;
+        size_t space = tail >= this->head ? POSIXSERIAL_BUFFER - tail : this->head - tail;
+
+        ssize_t n = ::read(this->fd, &this->fifo[tail], space);
+
+        if (n > 0)
+        {
+            this->count += n;
+            continue;
+        }
+
+        if (n < 0 && errno == EINTR)
+            continue;
+
+        /* with VMIN and VTIME 0 an empty tty reads 0, not EAGAIN */
+        if (n == 0 || errno == EAGAIN)
+            return;
+
+        hangUp();
+    }
+}
+
+void PosixSerial::waitReadable(int ms)
+{
+    /* a closed port still waits, so a caller polling for a reply does not spin */
+    struct pollfd p = { this->fd, POLLIN, 0 };
+
+    this->waits++;
+
+    while (poll(&p, 1, ms) < 0 && errno == EINTR)
+        ;
+
+    if (p.revents & (POLLHUP | POLLERR) && !(p.revents & POLLIN))
+        hangUp();
+}
+
+void PosixSerial::hangUp()
+{
+    /* adapter unplugged or far end of a pty closed, what is buffered can still be read */
+    close(this->fd);
+    this->fd = -1;
+}
@@ -0,0 +1,91 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+/*
+   A Stream over a POSIX tty (e.g. /dev/ttyUSB0), so the library runs unchanged on
+   a Linux gateway with a USB-UART adapter. The port is raw 8N1 at the baud rate
+   given (9600 for the sensor) and is read without blocking.
+
+   The library waits for a reply by calling available() until enough bytes have
+   arrived. Rather than spinning there, a call which would return the same count
+   as the last, with nothing read since, waits in poll() for up to
+   POSIXSERIAL_WAIT ms for more bytes, returning as soon as one arrives.
+
+   Uses the system clock of the Arduino shim, not the virtual clock.
+*/
+
+#ifndef MHZ19_HOST_POSIX_SERIAL_H
+#define MHZ19_HOST_POSIX_SERIAL_H
+
+#include "Arduino.h"
+
+#define POSIXSERIAL_BUFFER 256			// Receive buffer (bytes)
+#define POSIXSERIAL_WAIT 10				// Longest wait in available() for more bytes (ms, about a frame at 9600)
+#define POSIXSERIAL_WRITE 500			// Longest wait for room to transmit (ms)
+
+class PosixSerial : public Stream
+{
+  public:
+	~PosixSerial() { end(); }
+
+	/*#####################-Initiation Functions-#####################*/
+
+	/* opens and configures the tty, false with errno set if it cannot */
+	bool begin(const char *path, unsigned long baudrate = 9600);
+
+	/* takes an open tty descriptor instead (e.g. a pty), closed by end() */
+	bool begin(int fd, unsigned long baudrate = 9600);
+
+	void end();
+	operator bool() { return this->fd >= 0; }
+
+	/*########################-Set Functions-##########################*/
+
+	/* longest wait for more bytes within available() (ms), 0 never waits */
+	void setWait(int wait) { this->wait = wait; };
+
+	/*########################-Get Functions-##########################*/
+
+	/* descriptor, for an event loop to watch (-1 when closed) */
+	int getFD() { return this->fd; };
+
+	/* times available() waited in poll(), for checking a caller is not spinning */
+	unsigned long getWaits() { return this->waits; };
+
+	/*######################-Stream Functions-########################*/
+
+	size_t write(uint8_t c) { return write(&c, 1); }
+	size_t write(const uint8_t *buffer, size_t size);
+	using Print::write;
+
+	/* waits until written bytes have left the port */
+	void flush();
+
+	int available();
+	int read();
+	int peek();
+
+  private:
+	/*###########################-Variables-##########################*/
+
+	int fd = -1;
+	int wait = POSIXSERIAL_WAIT;
+
+	uint8_t fifo[POSIXSERIAL_BUFFER];
+	size_t head = 0;
+	size_t count = 0;
+
+	int lastAvailable = -1;					// count last returned, -1 after a read or write
+	unsigned long waits = 0;
+
+	/*######################-Internal Functions-########################*/
+
+	/* moves what the tty holds into the buffer, without blocking */
+	void fill();
+
+	/* waits up to ms for the tty to become readable */
+	void waitReadable(int ms);
+
+	/* closes a port which has gone away, keeping the buffer */
+	void hangUp();
+};
+#endif
@@ -0,0 +1,114 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+/*
+   Host tool: power gates MHZ19Sim through MHZ19Power on a virtual clock and
+   measures the powered time per valid sample.
+
+   The supply pin the library drives switches the simulated sensor, which
+   ignores requests while OFF and during boot. Each cycle powers up, waits for
+   MHZ19Power to report ready, takes one sample and powers down. Warm-up
+   length varies per cycle (MHZ19Sim::setWarmup()), so detection from the
+   warm-up signature is compared with always waiting the full preheat.
+
+   Build (from this folder):
+     g++ -std=gnu++11 -O2 -I.. -I../../../src -o PowerGate PowerGate.cpp ../Arduino.cpp ../MHZ19Sim.cpp ../../../src/MHZ19*.cpp
+   Usage:
+     ./PowerGate [cycles]
+*/
+
+#include <Arduino.h>
+#include "MHZ19.h"
+#include "MHZ19Power.h"
+#include "MHZ19Sim.h"
+
+#define SUPPLY_PIN 5
+#define CYCLE_PERIOD 900000UL       // ms, one sample every 15 minutes
+
+MHZ19Sim sim;
+MHZ19 sensor;
+MHZ19Power power;
+
+/* the supply switch: the simulated sensor follows the pin */
+static void idle()
+{
+    hostAdvanceMicros(200);
+    sim.setPower(hostPinRead(SUPPLY_PIN) == HIGH);
+}
+
+int main(int argc, char *argv[])
+{
+    int cycles = argc > 1 ? atoi(argv[1]) : 96;
+
+    if (cycles < 1)
+        cycles = 1;
+
+    hostUseVirtualClock();
+    hostSetIdleHook(idle);
+
+    sim.setDrift(0, 5);
+    sim.begin("0443", 2000, 11);
+
+    /* identity and settings read once, at first power up */
+    sensor.begin(sim);
+    sensor.autoCalibration(false);
+    sensor.resetStats();
+
+    power.begin(sensor, SUPPLY_PIN);
+    idle();
+
+    unsigned long early = 0, tooSoon = 0, inaccurate = 0, warmupTotal = 0;
+    uint64_t start = hostMicros64();
+
+    for (int cycle = 0; cycle < cycles; cycle++)
+    {
+        /* warm-up varies between sensors and with temperature, 40 - 120s */
+        sim.setWarmup(40000UL + (unsigned long)(cycle * 37 % 81) * 1000UL);
+
+        uint64_t cycleStart = hostMicros64();
+
+        power.on();
+        idle();
+
+        while (power.update() != POWER_READY)
+            delay(100);
+
+        if (sim.isWarmingUp())
+            tooSoon++;
+
+        int CO2 = power.getCO2();
+        int expected = sim.getReading();
+
+        if (sensor.errorCode != RESULT_OK || CO2 - expected > 15 || expected - CO2 > 15)
+            inaccurate++;
+
+        if (power.getWarmupTime() < MHZ19_POWER_WARMUP)
+            early++;
+
+        warmupTotal += power.getWarmupTime();
+
+        power.off();
+        idle();
+
+        hostAdvanceMicros(cycleStart + CYCLE_PERIOD * 1000ULL - hostMicros64());
+    }
+
+    double hours = (double)(hostMicros64() - start) / 3600000000.0;
+    unsigned long averageWarmup = warmupTotal / cycles;
+    unsigned long perSample = power.getOnTimePerSample();
+    unsigned long preheat = perSample - averageWarmup + MHZ19_POWER_WARMUP;
+
+    printf("Simulated %.1f hours, %d power cycles, %lu valid samples\n", hours, cycles, power.getSamples());
+    printf("Ready after %lums on average (%lu of %d before the full %lums preheat)\n", averageWarmup, early, cycles, MHZ19_POWER_WARMUP);
+    printf("Powered %lums per valid sample, %lums waiting the full preheat (%.0f%% saved)\n",
+           perSample, preheat, 100.0 * (preheat - perSample) / preheat);
+    printf("Sampled during warm-up %lu, inaccurate %lu, timed out requests %lu\n",
+           tooSoon, inaccurate, sensor.getResultCount(RESULT_TIMEOUT));
+
+    /* the sensor is never asked while booting, nor sampled before it has warmed */
+    bool failed = tooSoon || inaccurate || power.getSamples() != (unsigned long)cycles
+                  || sensor.getResultCount(RESULT_TIMEOUT) || early < (unsigned long)cycles / 2;
+
+    printf("%s\n", failed ? "FAIL" : "PASS");
+
+    return failed ? 1 : 0;
+}
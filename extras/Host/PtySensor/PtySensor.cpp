@@ -0,0 +1,230 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+/*
+   Host tool: runs the library over a real tty with PosixSerial, against
+   MHZ19Sim playing the sensor on the other end of a pseudo terminal pair.
+
+   A thread relays bytes between the pty master and the simulated sensor on
+   the system clock, so replies arrive with the sensor's latency and 9600 baud
+   timing. The library, unchanged, opens the pty slave as it would a
+   USB-UART adapter on a Linux gateway. After checking the version, range and
+   ABC commands, it takes readings with CRC, time out and garbage faults
+   injected.
+
+   The program exits non-zero if a command fails, a fault is not reported, a
+   reading is out of range, or the library's thread used more than
+   MAX_CPU_PERCENT of the wall time (it should wait in poll(), not spin).
+
+   With -s it only plays the sensor, printing the pty to point a program at.
+
+   Build (from this folder):
+     g++ -std=gnu++11 -O2 -pthread -I.. -I../../../src -o PtySensor PtySensor.cpp ../Arduino.cpp ../MHZ19Sim.cpp ../PosixSerial.cpp ../../../src/MHZ19*.cpp
+   Usage:
+     ./PtySensor [readings]
+     ./PtySensor -s
+*/
+
+#include <Arduino.h>
+#include <atomic>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include "MHZ19.h"
+#include "MHZ19Sim.h"
+#include "PosixSerial.h"
+
+#define READINGS 200
+#define FAULT_PERCENT 3             // of replies given each fault while reading
+#define MAX_CPU_PERCENT 10          // library thread CPU time, of wall time
+
+MHZ19Sim sim;
+PosixSerial port;
+MHZ19 sensor;
+
+int master = -1;
+std::atomic<bool> isFaulty(false);
+std::atomic<bool> isDone(false);
+
+/* relays the pty master to and from the simulated sensor */
+void playSensor()
+{
+    bool wasFaulty = false;
+    uint8_t buffer[64];
+
+    while (!isDone)
+    {
+        if (isFaulty != wasFaulty)
+        {
+            wasFaulty = isFaulty;
+            sim.setFaults(wasFaulty ? FAULT_PERCENT : 0, wasFaulty ? FAULT_PERCENT : 0, wasFaulty ? FAULT_PERCENT : 0);
+        }
+
+        /* wakes for a request, or each ms to release queued reply bytes on time */
+        struct pollfd p = { master, POLLIN, 0 };
+        poll(&p, 1, 1);
+
+        ssize_t n = read(master, buffer, sizeof(buffer));
+
+        for (ssize_t i = 0; i < n; i++)
+            sim.write(buffer[i]);
+
+        size_t out = 0;
+
+        while (out < sizeof(buffer) && sim.available())
+            buffer[out++] = sim.read();
+
+        if (out && write(master, buffer, out) < 0 && errno != EAGAIN)
+            break;
+    }
+}
+
+/* opens a pty pair, the master for the sensor and the slave's path for the port */
+const char *openPty()
+{
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0)
+        return NULL;
+
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    return ptsname(master);
+}
+
+double cpuSeconds(clockid_t clock)
+{
+    struct timespec ts;
+
+    clock_gettime(clock, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+    bool isServeOnly = argc > 1 && !strcmp(argv[1], "-s");
+    unsigned long readings = argc > 1 && !isServeOnly ? strtoul(argv[1], NULL, 10) : READINGS;
+
+    const char *slave = openPty();
+
+    if (!slave)
+    {
+        perror("pty");
+        return 1;
+    }
+
+    /* starts the shim's clock before the sensor's thread reads it */
+    millis();
+
+    if (isServeOnly)
+    {
+        sim.setRoom();
+        sim.begin();
+
+        printf("MH-Z19 on %s, 9600 8N1 (Ctrl-C to stop)\n", slave);
+        fflush(stdout);
+
+        /* keeps a slave open, so the master reads no hang up between clients */
+        int hold = open(slave, O_RDWR | O_NOCTTY);
+
+        playSensor();
+        close(hold);
+        return 0;
+    }
+
+    sim.setWarmup(0);
+    sim.begin("0443", 2000, 7);
+
+    if (!port.begin(slave, 9600))
+    {
+        perror(slave);
+        return 1;
+    }
+
+    std::thread sensorThread(playSensor);
+
+    bool failed = false;
+    double wallStart = cpuSeconds(CLOCK_MONOTONIC);
+    double cpuStart = cpuSeconds(CLOCK_THREAD_CPUTIME_ID);
+
+    /* commands */
+    sensor.begin(port);
+
+    char version[5] = { 0 };
+    sensor.getVersion(version);
+    int range = sensor.getRange();
+
+    sensor.setRange(5000);
+    byte rangeResult = sensor.errorCode;
+
+    sensor.autoCalibration(false);
+    byte ABCResult = sensor.errorCode;
+
+    printf("%s: version %s, range %d, setRange %s, autoCalibration %s\n", slave, version, range,
+           rangeResult == RESULT_OK ? "OK" : "failed", ABCResult == RESULT_OK ? "OK" : "failed");
+
+    if (strcmp(version, "0443") || range != 2000 || rangeResult != RESULT_OK || ABCResult != RESULT_OK)
+        failed = true;
+
+    unsigned long commandTimeouts = sensor.getResultCount(RESULT_TIMEOUT);
+
+    /* readings with faults */
+    isFaulty = true;
+
+    unsigned long accepted = 0, wrong = 0;
+
+    for (unsigned long i = 0; i < readings; i++)
+    {
+        int ppm = sensor.getCO2();
+
+        if (sensor.errorCode != RESULT_OK)
+            continue;
+
+        accepted++;
+
+        if (ppm < 300 || ppm > 5000)
+            wrong++;
+    }
+
+    double wall = cpuSeconds(CLOCK_MONOTONIC) - wallStart;
+    double cpu = cpuSeconds(CLOCK_THREAD_CPUTIME_ID) - cpuStart;
+
+    isDone = true;
+    sensorThread.join();
+    port.end();
+
+    unsigned long timeouts = sensor.getResultCount(RESULT_TIMEOUT) - commandTimeouts;
+    unsigned long corrupt = sensor.getResultCount(RESULT_CRC) + sensor.getResultCount(RESULT_MATCH);
+
+    printf("readings: accepted %lu of %lu, out of range %lu\n", accepted, readings, wrong);
+    printf("results:  timeout %lu  crc %lu  match %lu\n", timeouts, sensor.getResultCount(RESULT_CRC),
+           sensor.getResultCount(RESULT_MATCH));
+    printf("faults:   crc %lu  timeout %lu  garbage %lu\n", sim.getFaultCount(SIM_FAULT_CRC),
+           sim.getFaultCount(SIM_FAULT_TIMEOUT), sim.getFaultCount(SIM_FAULT_GARBAGE));
+    printf("sensor:   range %d, ABC %s\n", sim.getRange(), sim.getABC() ? "ON" : "OFF");
+    printf("library thread: %.2fs wall, %.3fs CPU (%.1f%%), %lu waits in poll()\n", wall, cpu,
+           wall > 0 ? 100 * cpu / wall : 0.0, port.getWaits());
+
+    if (commandTimeouts || wrong || !accepted)
+        failed = true;
+
+    /* every dropped reply times out, every corrupted one is reported */
+    if (timeouts != sim.getFaultCount(SIM_FAULT_TIMEOUT) || corrupt < sim.getFaultCount(SIM_FAULT_CRC))
+        failed = true;
+
+    if (sim.getRange() != 5000 || sim.getABC())
+        failed = true;
+
+    if (cpu > wall * MAX_CPU_PERCENT / 100)
+    {
+        printf("library thread spun while waiting\n");
+        failed = true;
+    }
+
+    printf("%s\n", failed ? "FAIL" : "PASS");
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,195 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+/*
+   Host tool: fits a MHZ19RawModel lookup table from logged (raw, ppm) pairs.
+
+   Input is one pair per line, "raw,ppm" (as printed by examples/RawModel with
+   LOG_PAIRS set), anything else is skipped. Samples are sorted by raw, split
+   into equally populated bins, and each bin becomes one knot (mean raw, mean
+   ppm). As raw falls when CO2 rises, knots are made monotonic (disable with -f).
+   The table is written to stdout as a PROGMEM array, fit errors to stderr.
+
+   Build:  g++ -std=c++11 -O2 -o RawFit RawFit.cpp
+   Usage:  ./RawFit [-k knots] [-n name] [-f] < pairs.csv > table.h
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+struct Pair
+{
+    long raw;
+    long ppm;
+};
+
+struct Knot
+{
+    double raw;
+    double ppm;
+    double weight;
+};
+
+/* same integer interpolation as MHZ19RawModel::toPPM(), in the 32 bits an AVR long has */
+static int32_t interpolate(const std::vector<Pair> &table, long raw)
+{
+    if (raw <= table.front().raw || table.size() == 1)
+        return table.front().ppm;
+    if (raw >= table.back().raw)
+        return table.back().ppm;
+
+    size_t first = 0, last = table.size() - 1;
+    while (last - first > 1)
+    {
+        size_t mid = (first + last) / 2;
+        if (raw < table[mid].raw)
+            last = mid;
+        else
+            first = mid;
+    }
+
+    uint32_t span = (uint32_t)(table[last].raw - table[first].raw);
+    uint32_t offset = (uint32_t)(raw - table[first].raw);
+    int32_t step = (int32_t)(table[last].ppm - table[first].ppm);
+    uint32_t magnitude = step < 0 ? -step : step;
+
+    uint32_t moved = offset * (magnitude / span) + (offset * (magnitude % span) + span / 2) / span;
+
+    return step < 0 ? (int32_t)table[first].ppm - (int32_t)moved : (int32_t)table[first].ppm + (int32_t)moved;
+}
+
+/* pool adjacent violators, forcing ppm to be non-increasing with raw */
+static void makeMonotonic(std::vector<Knot> &knots)
+{
+    std::vector<Knot> pooled;
+
+    for (size_t i = 0; i < knots.size(); i++)
+    {
+        pooled.push_back(knots[i]);
+
+        while (pooled.size() > 1 && pooled[pooled.size() - 2].ppm < pooled.back().ppm)
+        {
+            Knot b = pooled.back();
+            pooled.pop_back();
+            Knot &a = pooled.back();
+
+            double w = a.weight + b.weight;
+            a.raw = (a.raw * a.weight + b.raw * b.weight) / w;
+            a.ppm = (a.ppm * a.weight + b.ppm * b.weight) / w;
+            a.weight = w;
+        }
+    }
+    knots.swap(pooled);
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: RawFit [-k knots] [-n name] [-f] < pairs.csv > table.h\n");
+    exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t knotCount = 16;
+    const char *name = "rawTable";
+    bool monotonic = true;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-k") && i + 1 < argc)
+            knotCount = strtoul(argv[++i], NULL, 10);
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            name = argv[++i];
+        else if (!strcmp(argv[i], "-f"))
+            monotonic = false;
+        else
+            usage();
+    }
+    if (knotCount < 2 || knotCount > 255)
+        usage();
+
+    /* read pairs, skipping headers, comments and malformed lines */
+    std::vector<Pair> samples;
+    char line[256];
+
+    while (fgets(line, sizeof(line), stdin))
+    {
+        long raw, ppm;
+        if (sscanf(line, " %ld %*[,;] %ld", &raw, &ppm) == 2 || sscanf(line, " %ld %ld", &raw, &ppm) == 2)
+        {
+            if (raw > 0 && raw <= 65535 && ppm >= 0 && ppm <= 32767)
+                samples.push_back({raw, ppm});
+        }
+    }
+
+    if (samples.size() < 2)
+    {
+        fprintf(stderr, "RawFit: need at least 2 valid pairs, got %zu\n", samples.size());
+        return 1;
+    }
+
+    std::sort(samples.begin(), samples.end(), [](const Pair &a, const Pair &b) { return a.raw < b.raw; });
+
+    /* equally populated bins, each averaged into a knot */
+    knotCount = std::min(knotCount, samples.size());
+    std::vector<Knot> knots;
+
+    for (size_t k = 0; k < knotCount; k++)
+    {
+        size_t from = samples.size() * k / knotCount;
+        size_t to = samples.size() * (k + 1) / knotCount;
+        Knot knot = {0, 0, (double)(to - from)};
+
+        for (size_t i = from; i < to; i++)
+        {
+            knot.raw += samples[i].raw;
+            knot.ppm += samples[i].ppm;
+        }
+        knot.raw /= knot.weight;
+        knot.ppm /= knot.weight;
+        knots.push_back(knot);
+    }
+
+    if (monotonic)
+        makeMonotonic(knots);
+
+    /* round to integers, dropping knots whose raw collides with the previous one */
+    std::vector<Pair> table;
+
+    for (size_t i = 0; i < knots.size(); i++)
+    {
+        Pair p = {lround(knots[i].raw), lround(knots[i].ppm)};
+
+        if (table.empty() || p.raw > table.back().raw)
+            table.push_back(p);
+    }
+
+    /* evaluate with the on-device arithmetic */
+    double sumSq = 0;
+    long maxErr = 0;
+
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        long err = interpolate(table, samples[i].raw) - samples[i].ppm;
+        sumSq += (double)err * err;
+        maxErr = std::max(maxErr, std::labs(err));
+    }
+
+    fprintf(stderr, "RawFit: %zu pairs, %zu knots, rms error %.1f ppm, max error %ld ppm\n",
+            samples.size(), table.size(), sqrt(sumSq / samples.size()), maxErr);
+
+    printf("/* generated by RawFit from %zu pairs, rms error %.1f ppm, max error %ld ppm */\n",
+           samples.size(), sqrt(sumSq / samples.size()), maxErr);
+    printf("const MHZ19RawPoint %s[%zu] PROGMEM = {\n", name, table.size());
+
+    for (size_t i = 0; i < table.size(); i++)
+        printf("    {%ld, %ld}%s\n", table[i].raw, table[i].ppm, i + 1 < table.size() ? "," : "");
+
+    printf("};\n");
+
+    return 0;
+}
@@ -0,0 +1,178 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+/*
+   Host tool: runs the event driven receive path (requestCO2(), receive() from
+   the UART receive event, onFrame()) against a simulated sensor on a virtual
+   clock.
+
+   The sensor answers each request after a delay, trickling its reply a few
+   bytes at a time as a UART would. Some replies are preceded by line noise,
+   corrupted or dropped. Completed frames are checked against the value sent,
+   and the program exits non-zero if a wrong value is accepted, a fault is not
+   reported, or receive() ran while no bytes had arrived.
+
+   Build (from this folder):
+     g++ -std=gnu++11 -O2 -I.. -I../../../src -o ReceiveEvents ReceiveEvents.cpp ../Arduino.cpp ../../../src/MHZ19*.cpp
+*/
+
+#include <Arduino.h>
+#include "MHZ19.h"
+
+#define REQUESTS 2000
+#define REPLY_DELAY_US 30000    // sensor processing time before replying
+#define BYTE_US 1042            // one byte at 9600 baud
+
+HostUART uart;
+MHZ19 sensor;
+
+/* simulated sensor */
+struct
+{
+    byte request[MHZ19_DATA_LEN];
+    byte count;
+    byte reply[MHZ19_DATA_LEN + 4];
+    byte replyLen;
+    byte sent;
+    uint64_t nextByte;          // virtual time of the next reply byte, 0 if idle
+    int ppm;                    // value in the reply
+    byte fault;                 // 0 none, 1 noise before, 2 corrupted, 3 dropped
+} sim;
+
+/* results */
+unsigned long frames = 0, valid = 0, wrongValue = 0, faultsMissed = 0, events = 0, idleReceives = 0;
+unsigned long codes[6];
+
+void onTransmit(uint8_t c, void *)
+{
+    if (!sim.count && c != 0xFF)
+        return;
+
+    sim.request[sim.count++] = c;
+
+    if (sim.count < MHZ19_DATA_LEN)
+        return;
+
+    sim.count = 0;
+    /* command 162 (last response) repeats the previous reading, as verify() expects */
+    if (sim.request[2] != 0xA2)
+    {
+        sim.ppm = 400 + rand() % 4600;
+        sim.fault = (rand() % 10 == 0) ? 1 + rand() % 3 : 0;
+    }
+    else
+        sim.fault = 0;
+
+    /* command 133 layout, ppm in bytes 4 & 5 */
+    byte frame[MHZ19_DATA_LEN] = { 0xFF, sim.request[2], 0x0F, 0x9C, (byte)(sim.ppm >> 8), (byte)sim.ppm, 0, 0, 0 };
+    byte crc = 0;
+
+    for (byte x = 1; x < 8; x++)
+        crc += frame[x];
+    frame[8] = 255 - crc + 1;
+
+    if (sim.fault == 2)
+        frame[2 + rand() % 6] ^= 0x10;
+
+    sim.replyLen = 0;
+    if (sim.fault == 1)
+    {
+        sim.reply[sim.replyLen++] = 0x12;
+        sim.reply[sim.replyLen++] = 0x00;
+        sim.reply[sim.replyLen++] = 0x34;
+    }
+    memcpy(sim.reply + sim.replyLen, frame, MHZ19_DATA_LEN);
+    sim.replyLen += MHZ19_DATA_LEN;
+
+    sim.sent = 0;
+    sim.nextByte = (sim.fault == 3) ? 0 : hostMicros64() + REPLY_DELAY_US;
+}
+
+/* delivers due reply bytes, up to 3 per receive event (a UART FIFO threshold) */
+void stepSensor()
+{
+    if (!sim.nextByte || hostMicros64() < sim.nextByte)
+        return;
+
+    byte chunk = sim.replyLen - sim.sent;
+    if (chunk > 3)
+        chunk = 3;
+
+    uart.hostReceive(sim.reply + sim.sent, chunk);
+    sim.sent += chunk;
+
+    sim.nextByte = (sim.sent < sim.replyLen) ? hostMicros64() + (uint64_t)BYTE_US * chunk : 0;
+}
+
+/* blocking calls (begin()) wait here */
+void idle()
+{
+    hostAdvanceMicros(100);
+    stepSensor();
+}
+
+void onFrame(MHZ19 &mhz, byte command, byte result)
+{
+    (void)command;
+
+    frames++;
+    codes[result < 6 ? result : 0]++;
+
+    if (result == RESULT_OK)
+    {
+        valid++;
+
+        if (mhz.getCO2(true, false) != sim.ppm || sim.fault >= 2)
+            wrongValue++;
+    }
+    else if (!sim.fault)
+        faultsMissed++;
+}
+
+int main()
+{
+    hostUseVirtualClock();
+    hostSetIdleHook(idle);
+    srand(19);
+
+    uart.hostSetTransmitHook(onTransmit);
+    uart.onReceive([]() {
+        events++;
+        if (!uart.available())
+            idleReceives++;
+        sensor.receive();
+    });
+
+    if (sensor.begin(uart))
+        printf("begin failed, error %d\n", sensor.errorCode);
+    frames = valid = events = idleReceives = 0;
+    sensor.onFrame(onFrame);
+    sensor.autoMaintenance(false);
+
+    unsigned long sentCount = 0;
+
+    while (sentCount < REQUESTS || sensor.isPending())
+    {
+        if (!sensor.isPending() && sentCount < REQUESTS)
+        {
+            sensor.requestCO2();
+            sentCount++;
+        }
+
+        hostAdvanceMicros(1000);
+        stepSensor();
+
+        /* time outs are only noticed from the loop */
+        if (sensor.isPending() && millis() % 100 == 0)
+            sensor.receive();
+    }
+
+    printf("requests %lu  frames %lu  valid %lu  receive events %lu\n", sentCount, frames, valid, events);
+    printf("ok %lu  timeout %lu  crc %lu  match %lu\n", codes[RESULT_OK], codes[RESULT_TIMEOUT], codes[RESULT_CRC], codes[RESULT_MATCH]);
+    printf("wrong values %lu  faults missed %lu  empty events %lu\n", wrongValue, faultsMissed, idleReceives);
+
+    bool failed = wrongValue || faultsMissed || idleReceives || frames != sentCount;
+
+    printf("%s\n", failed ? "FAIL" : "PASS");
+
+    return failed ? 1 : 0;
+}
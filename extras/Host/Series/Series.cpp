@@ -0,0 +1,216 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+/*
+   Host tool: decodes MHZ19Series buffers, and benchmarks the compression on
+   readings taken from MHZ19Sim.
+
+   Benchmark: a week of readings, one a minute, is taken through MHZ19 from
+   the simulated sensor (occupied office, noise, drift) and compressed with
+   timestamps in seconds and in milliseconds. Reported are bytes per sample,
+   days held in 4KB, encode / decode throughput, and that every sample
+   decodes exactly.
+
+   Decode: reads a buffer saved from a node (the bytes from getBuffer(),
+   getSize() long) and writes "timestamp,ppm" lines.
+
+   Build (from this folder):
+     g++ -std=gnu++11 -O2 -I.. -I../../../src -o Series Series.cpp ../Arduino.cpp ../MHZ19Sim.cpp ../../../src/MHZ19*.cpp
+   Usage:
+     ./Series [days]
+     ./Series -d buffer.bin > samples.csv
+*/
+
+#include <Arduino.h>
+#include <chrono>
+#include <vector>
+#include "MHZ19.h"
+#include "MHZ19Series.h"
+#include "MHZ19Sim.h"
+
+#define SAMPLE_PERIOD 60000UL       // ms
+#define NODE_BUFFER 4096            // bytes
+
+MHZ19Sim sim;
+MHZ19 sensor;
+
+struct Sample
+{
+    unsigned long timestamp;
+    int ppm;
+};
+
+static void idle()
+{
+    hostAdvanceMicros(200);
+}
+
+static double seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int decode(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+
+    if (!file)
+    {
+        fprintf(stderr, "cannot open %s\n", path);
+        return 1;
+    }
+
+    std::vector<byte> buffer;
+    int c;
+
+    while ((c = fgetc(file)) != EOF)
+        buffer.push_back((byte)c);
+
+    fclose(file);
+
+    MHZ19SeriesReader reader;
+    reader.begin(buffer.data(), buffer.size());
+
+    unsigned long timestamp;
+    int ppm;
+    unsigned int read = 0;
+
+    while (reader.next(timestamp, ppm))
+    {
+        printf("%lu,%d\n", timestamp, ppm);
+        read++;
+    }
+
+    if (read != reader.getCount())
+    {
+        fprintf(stderr, "truncated: %u of %u samples\n", read, reader.getCount());
+        return 1;
+    }
+
+    return 0;
+}
+
+/* compresses samples, checks the round trip and times both directions */
+static bool bench(const char *label, const std::vector<Sample> &samples)
+{
+    std::vector<byte> buffer(samples.size() * 8 + 16);
+    MHZ19Series series;
+
+    series.begin(buffer.data(), buffer.size());
+
+    for (size_t i = 0; i < samples.size(); i++)
+        series.append(samples[i].timestamp, samples[i].ppm);
+
+    size_t size = series.getSize();
+
+    /* exact round trip */
+    MHZ19SeriesReader reader;
+    reader.begin(buffer.data(), size);
+
+    unsigned long timestamp;
+    int ppm;
+    size_t matched = 0;
+
+    while (reader.next(timestamp, ppm) && matched < samples.size()
+           && timestamp == samples[matched].timestamp && ppm == samples[matched].ppm)
+        matched++;
+
+    /* node sized buffer */
+    std::vector<byte> node(NODE_BUFFER);
+    MHZ19Series small;
+    small.begin(node.data(), node.size());
+
+    for (size_t i = 0; i < samples.size() && small.append(samples[i].timestamp, samples[i].ppm); i++)
+        ;
+
+    /* throughput, repeated for about half a second each way */
+    unsigned long rounds = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    do
+    {
+        series.clear();
+
+        for (size_t i = 0; i < samples.size(); i++)
+            series.append(samples[i].timestamp, samples[i].ppm);
+
+        rounds++;
+    } while (seconds(start) < 0.5);
+
+    double encodeRate = rounds * samples.size() / seconds(start) / 1e6;
+
+    rounds = 0;
+    long checksum = 0;
+    start = std::chrono::steady_clock::now();
+
+    do
+    {
+        reader.begin(buffer.data(), size);
+
+        while (reader.next(timestamp, ppm))
+            checksum += ppm;
+
+        rounds++;
+    } while (seconds(start) < 0.5);
+
+    double decodeRate = rounds * samples.size() / seconds(start) / 1e6;
+
+    double days = (double)small.getCount() * SAMPLE_PERIOD / 86400000.0;
+
+    printf("%s\n", label);
+    printf("  %zu samples in %zu bytes, %.2f bytes per sample (%zu bytes as int + unsigned long on AVR)\n",
+           samples.size(), size, (double)size / samples.size(), samples.size() * 6);
+    printf("  %dKB holds %u samples, %.1f days\n", NODE_BUFFER / 1024, small.getCount(), days);
+    printf("  encode %.1f M samples/s, decode %.1f M samples/s (checksum %ld)\n", encodeRate, decodeRate, checksum);
+    printf("  round trip %zu of %zu exact\n", matched, samples.size());
+
+    return matched == samples.size();
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 2 && !strcmp(argv[1], "-d"))
+        return decode(argv[2]);
+
+    int days = argc > 1 ? atoi(argv[1]) : 7;
+
+    if (days < 1)
+        days = 1;
+
+    hostUseVirtualClock();
+    hostSetIdleHook(idle);
+
+    sim.setRoom();
+    sim.setDrift(5, 10);
+    sim.begin("0443", 2000, 5);
+
+    sensor.begin(sim);
+    sensor.autoCalibration(false);
+    sensor.setFilter(true, true);
+
+    std::vector<Sample> seconds, millis;
+    uint64_t start = hostMicros64();
+    uint64_t end = start + (uint64_t)days * 86400000000ULL;
+
+    /* the sample period as a node keeps it, a few ms late each time */
+    for (uint64_t next = start; next < end; next += SAMPLE_PERIOD * 1000ULL)
+    {
+        hostAdvanceMicros(next - hostMicros64() + (next / 7919) % 3000);
+
+        int ppm = sensor.getCO2();
+
+        if (sensor.errorCode != RESULT_OK)
+            continue;
+
+        unsigned long ms = (unsigned long)((hostMicros64() - start) / 1000);
+
+        millis.push_back(Sample{ ms, ppm });
+        seconds.push_back(Sample{ (ms + 500) / 1000, ppm });
+    }
+
+    bool passed = bench("Timestamps in seconds", seconds);
+    passed = bench("Timestamps in milliseconds", millis) && passed;
+
+    printf("%s\n", passed ? "PASS" : "FAIL");
+
+    return passed ? 0 : 1;
+}
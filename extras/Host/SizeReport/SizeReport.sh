@@ -0,0 +1,94 @@
+#!/bin/sh
+#   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com
+#
+# Host tool: lists the flash and RAM taken by the library for each compile-time
+# feature configuration (MHZ19_ENABLE_* and MHZ19_ERRORS in MHZ19.h).
+#
+# Host mode (default) links Sketch.cpp (begin() and getCO2() only) with the host
+# compiler at -Os with unused sections removed, as the Arduino build does, and
+# sums the sizes of the library's symbols: code (flash) and the MHZ19 object plus
+# tables (RAM). Figures are for the host instruction set, so compare
+# configurations rather than reading them as AVR bytes. "Serial" shows whether
+# the library refers to the hardware serial port, which on an ATmega328 costs
+# about 1KB of flash and 180 bytes of RAM when the sketch does not use it.
+#
+# Board mode builds examples/BasicUsage for a board with arduino-cli and reports
+# its "Sketch uses" / "Global variables use" totals, the figures that matter on
+# the device.
+#
+# Usage (from this folder):
+#   sh SizeReport.sh
+#   sh SizeReport.sh arduino:avr:uno
+
+ROOT=../../..
+BUILD=${TMPDIR:-/tmp}/mhz19_size
+FQBN=$1
+
+# name and flags of each configuration
+CONFIGS="
+full|
+no-print|-DMHZ19_ENABLE_PRINT=0
+no-filter|-DMHZ19_ENABLE_FILTER=0
+no-prefetch|-DMHZ19_ENABLE_PREFETCH=0
+no-async|-DMHZ19_ENABLE_ASYNC=0
+no-raw|-DMHZ19_ENABLE_RAW=0
+no-errors|-DMHZ19_ERRORS=0
+minimal|-DMHZ19_ENABLE_PRINT=0 -DMHZ19_ENABLE_FILTER=0 -DMHZ19_ENABLE_PREFETCH=0 -DMHZ19_ENABLE_ASYNC=0 -DMHZ19_ENABLE_RAW=0 -DMHZ19_ERRORS=0
+"
+
+mkdir -p "$BUILD" || exit 1
+
+if [ -n "$FQBN" ]; then
+    printf "%-12s %10s %10s\n" "config" "flash" "RAM"
+else
+    printf "%-12s %10s %10s %8s\n" "config" "flash" "RAM" "Serial"
+fi
+
+echo "$CONFIGS" | while IFS='|' read -r NAME FLAGS; do
+    [ -z "$NAME" ] && continue
+
+    if [ -n "$FQBN" ]; then
+        OUT=$(arduino-cli compile --fqbn "$FQBN" --library "$ROOT" --build-path "$BUILD/$NAME" \
+              --build-property "compiler.cpp.extra_flags=$FLAGS" "$ROOT/examples/BasicUsage" 2>&1)
+
+        FLASH=$(echo "$OUT" | sed -n 's/^Sketch uses \([0-9]*\) bytes.*/\1/p')
+        RAM=$(echo "$OUT" | sed -n 's/^Global variables use \([0-9]*\) bytes.*/\1/p')
+
+        if [ -z "$FLASH" ]; then
+            echo "$NAME: build failed" >&2
+            echo "$OUT" >&2
+            exit 1
+        fi
+
+        printf "%-12s %10s %10s\n" "$NAME" "$FLASH" "$RAM"
+        continue
+    fi
+
+    # shellcheck disable=SC2086
+    if ! ${CXX:-g++} -std=gnu++11 -Os -ffunction-sections -fdata-sections -Wl,--gc-sections $FLAGS \
+         -I.. -I$ROOT/src -o "$BUILD/$NAME" Sketch.cpp ../Arduino.cpp $ROOT/src/MHZ19.cpp \
+         $ROOT/src/MHZ19Scheduler.cpp $ROOT/src/MHZ19PWM.cpp; then
+        echo "$NAME: build failed" >&2
+        exit 1
+    fi
+
+    # shellcheck disable=SC2086
+    ${CXX:-g++} -std=gnu++11 -Os $FLAGS -I.. -I$ROOT/src -c -o "$BUILD/$NAME.o" $ROOT/src/MHZ19.cpp || exit 1
+
+    SERIAL=no
+    nm -C -u "$BUILD/$NAME.o" | grep -qw Serial && SERIAL=yes
+
+    # library symbols: code is flash, the MHZ19 object and tables are RAM
+    nm -S -C -t d "$BUILD/$NAME" | awk -v name="$NAME" -v serial="$SERIAL" '
+        NF >= 4 {
+            size = $2 + 0; type = $3; symbol = $4
+            for (i = 5; i <= NF; i++) symbol = symbol " " $i
+
+            if (symbol ~ /MHZ19/ || symbol ~ /^Commands$/) {
+                if (type ~ /[TtWw]/) flash += size
+                else if (type ~ /[BbDd]/) ram += size
+                else if (type ~ /[Rr]/) flash += size
+            }
+        }
+        END { printf "%-12s %10d %10d %8s\n", name, flash, ram, serial }'
+done
@@ -0,0 +1,30 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+/*
+   The sketch measured by SizeReport.sh: begin() and getCO2() only, as the
+   smallest useful program. Not meant to be run.
+*/
+
+#include <Arduino.h>
+#include "MHZ19.h"
+
+/* a port which never answers, enough to link against */
+class NullPort : public Stream
+{
+  public:
+    size_t write(uint8_t) { return 1; }
+    using Print::write;
+    int available() { return 0; }
+    int read() { return -1; }
+    int peek() { return -1; }
+};
+
+NullPort port;
+MHZ19 myMHZ19;
+
+int main()
+{
+    myMHZ19.begin(port);
+
+    return myMHZ19.getCO2();
+}
@@ -0,0 +1,169 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+/*
+   Host tool: soak test of the library against MHZ19Sim on a virtual clock,
+   replaying days of operation in seconds.
+
+   Two sensors in the same room drift by the same amount. One has ABC turned
+   OFF, which the library must keep resending every 12 hours. The other
+   leaves ABC ON. Both read CO2 every 5 seconds in filter mode, and 1% of
+   replies each get a CRC, time out or garbage fault. Halfway through day 1
+   the first sensor gets a recovery reset.
+
+   The program exits non-zero if a warm-up reading (410 limited / abnormal
+   unlimited) gets past the filter, ABC OFF was not resent on time, or an
+   accepted reading is further than 50ppm from what the sensor measured.
+
+   Build (from this folder):
+     g++ -std=gnu++11 -O2 -I.. -I../../../src -o Soak Soak.cpp ../Arduino.cpp ../MHZ19Sim.cpp ../../../src/MHZ19*.cpp
+   Usage:
+     ./Soak [days]
+*/
+
+#include <Arduino.h>
+#include <time.h>
+#include "MHZ19.h"
+#include "MHZ19Sim.h"
+
+#define READ_INTERVAL 5000UL        // ms between readings
+#define ACCEPT_ERROR 50             // ppm from the simulated sensor's own reading
+
+struct SoakUnit
+{
+    const char *name;
+    MHZ19Sim sim;
+    MHZ19 sensor;
+    unsigned long accepted, filtered, failed, leaked, wrong;
+    long long errorSum;
+};
+
+static SoakUnit units[2];
+
+/* the library's waits step the clock */
+static void idle()
+{
+    hostAdvanceMicros(200);
+}
+
+static void readUnit(SoakUnit &u)
+{
+    bool isWarming = u.sim.isWarmingUp();
+    int CO2 = u.sensor.getCO2();
+
+    if (u.sensor.errorCode == RESULT_FILTER)
+    {
+        u.filtered++;
+        return;
+    }
+
+    if (u.sensor.errorCode != RESULT_OK)
+    {
+        u.failed++;
+        return;
+    }
+
+    u.accepted++;
+
+    if (isWarming || u.sim.isWarmingUp())
+    {
+        u.leaked++;
+        return;
+    }
+
+    long error = labs((long)CO2 - u.sim.getReading());
+    u.errorSum += error;
+
+    if (error > ACCEPT_ERROR)
+        u.wrong++;
+}
+
+int main(int argc, char *argv[])
+{
+    int days = argc > 1 ? atoi(argv[1]) : 3;
+
+    if (days < 1)
+        days = 1;
+
+    hostUseVirtualClock();
+    hostSetIdleHook(idle);
+
+    clock_t wallStart = clock();
+
+    units[0].name = "ABC OFF";
+    units[1].name = "ABC ON";
+
+    for (byte i = 0; i < 2; i++)
+    {
+        SoakUnit &u = units[i];
+
+        u.sim.setRoom(420, 900, 8, 18);
+        u.sim.setDrift(10, 10);
+        u.sim.setFaults(1, 1, 1);
+        u.sim.begin("0443", 2000, 19 + i);
+
+        u.sensor.begin(u.sim);
+        u.sensor.autoCalibration(i == 1);
+        u.sensor.setFilter(true, true);
+    }
+
+    uint64_t end = (uint64_t)days * 86400000ULL;
+    uint64_t start = hostMicros64() / 1000;
+    uint64_t resetAt = 36ULL * 3600000ULL;
+    bool isReset = false;
+
+    for (uint64_t next = start + READ_INTERVAL; next - start < end; next += READ_INTERVAL)
+    {
+        uint64_t now = hostMicros64() / 1000;
+
+        if (now < next)
+            hostAdvanceMicros((next - now) * 1000);
+
+        if (!isReset && next - start >= resetAt)
+        {
+            units[0].sensor.recoveryReset();
+            isReset = true;
+        }
+
+        for (byte i = 0; i < 2; i++)
+            readUnit(units[i]);
+    }
+
+    double wall = (double)(clock() - wallStart) / CLOCKS_PER_SEC;
+    double simulated = (double)(hostMicros64() / 1000 - start) / 1000;
+
+    printf("Simulated %.1f days in %.2fs (%.0fx real time)\n\n", simulated / 86400, wall, wall > 0 ? simulated / wall : 0);
+
+    bool failed = false;
+
+    for (byte i = 0; i < 2; i++)
+    {
+        SoakUnit &u = units[i];
+
+        printf("%s\n", u.name);
+        printf("  readings: accepted %lu  filtered %lu  failed %lu\n", u.accepted, u.filtered, u.failed);
+        printf("  results:  ok %lu  timeout %lu  match %lu  crc %lu  filter %lu\n",
+               u.sensor.getResultCount(RESULT_OK), u.sensor.getResultCount(RESULT_TIMEOUT),
+               u.sensor.getResultCount(RESULT_MATCH), u.sensor.getResultCount(RESULT_CRC),
+               u.sensor.getResultCount(RESULT_FILTER));
+        printf("  faults:   crc %lu  timeout %lu  garbage %lu\n", u.sim.getFaultCount(SIM_FAULT_CRC),
+               u.sim.getFaultCount(SIM_FAULT_TIMEOUT), u.sim.getFaultCount(SIM_FAULT_GARBAGE));
+        printf("  ABC commands %lu, ABC %s, baseline offset %+d ppm\n", u.sim.getCommandCount(0x79),
+               u.sim.getABC() ? "ON" : "OFF", u.sim.getOffset());
+        printf("  warm-up leaks %lu  wrong %lu  mean error %.1f ppm\n\n", u.leaked, u.wrong,
+               u.accepted ? (double)u.errorSum / u.accepted : 0.0);
+
+        if (u.leaked || u.wrong)
+            failed = true;
+    }
+
+    /* one ABC OFF at begin, then one every 12 hours before the end */
+    if (units[0].sim.getABC() || units[0].sim.getCommandCount(0x79) < (unsigned long)days * 2)
+    {
+        printf("ABC OFF was not kept up\n");
+        failed = true;
+    }
+
+    printf("%s\n", failed ? "FAIL" : "PASS");
+
+    return failed ? 1 : 0;
+}
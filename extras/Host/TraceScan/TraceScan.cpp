@@ -0,0 +1,227 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+/*
+   Host tool: validates captured MH-Z19 UART traces (see MHZ19Trace.h for the
+   record format) and summarises error rates and reply latency per unit.
+
+   Files are memory-mapped and checked in batches by the SSE2 kernel, "-"
+   reads a pipe. Throughput is reported on stderr.
+
+   -g writes a synthetic trace (units exchanging requests and replies, with
+   CRC, framing, mismatch and lost reply faults at known rates) and -b
+   benchmarks both kernels on one in memory, checking they agree.
+
+   Build (from this folder):
+     g++ -std=gnu++11 -O2 -I.. -o TraceScan TraceScan.cpp ../MHZ19Trace.cpp
+   Usage:
+     ./TraceScan [-e] [-s] trace.bin... ('-' for standard input, -e units with errors only, -s portable kernel)
+     ./TraceScan -g units exchanges trace.bin
+     ./TraceScan -b [MB]
+*/
+
+#include <chrono>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "MHZ19Trace.h"
+
+/* faults per 10000 exchanges in generated traces */
+#define FAULT_CRC 100
+#define FAULT_FRAMING 20
+#define FAULT_MISMATCH 10
+#define FAULT_LOST 50
+
+static uint32_t seed = 1;
+
+static uint32_t nextRandom()
+{
+    seed = seed * 1103515245 + 12345;
+
+    return seed >> 8;
+}
+
+static void putRecord(std::vector<uint8_t> &out, uint32_t time, uint16_t unit, uint8_t direction, const uint8_t frame[9])
+{
+    uint8_t record[MHZ19TRACE_RECORD] = { (uint8_t)time, (uint8_t)(time >> 8), (uint8_t)(time >> 16), (uint8_t)(time >> 24),
+                                          (uint8_t)unit, (uint8_t)(unit >> 8), direction };
+
+    memcpy(record + MHZ19TRACE_FRAME, frame, 9);
+    out.insert(out.end(), record, record + MHZ19TRACE_RECORD);
+}
+
+static void setCRC(uint8_t frame[9])
+{
+    uint8_t sum = 0;
+
+    for (uint8_t x = 1; x < 8; x++)
+        sum += frame[x];
+
+    frame[8] = 255 - sum + 1;
+}
+
+/* each round every unit requests CO2 and (mostly) gets a reply 20 - 45ms later */
+static void generate(std::vector<uint8_t> &out, unsigned units, unsigned long exchanges)
+{
+    out.reserve(out.size() + (size_t)exchanges * 2 * MHZ19TRACE_RECORD);
+
+    unsigned long made = 0;
+
+    for (uint32_t round = 0; made < exchanges; round++)
+    {
+        uint32_t base = round * 2000000U;
+
+        for (unsigned unit = 0; unit < units && made < exchanges; unit++, made++)
+        {
+            uint32_t time = base + unit * 500;
+            uint8_t request[9] = { 0xFF, 0x01, 0x85, 0, 0, 0, 0, 0, 0 };
+
+            setCRC(request);
+            putRecord(out, time, (uint16_t)unit, MHZ19TRACE_TX, request);
+
+            uint32_t roll = nextRandom() % 10000;
+
+            if (roll < FAULT_LOST)
+                continue;
+
+            int ppm = 400 + nextRandom() % 1600;
+            uint8_t reply[9] = { 0xFF, 0x85, 0x08, 0x34, (uint8_t)(ppm >> 8), (uint8_t)ppm, 0, 0, 0 };
+
+            /* one fault at most, from consecutive ranges of the roll */
+            roll -= FAULT_LOST;
+
+            if (roll < FAULT_MISMATCH)
+                reply[1] = 0x86;
+
+            setCRC(reply);
+
+            if (roll >= FAULT_MISMATCH && roll < FAULT_MISMATCH + FAULT_CRC)
+                reply[8] ^= 0x5A;
+            else if (roll >= FAULT_MISMATCH + FAULT_CRC && roll < FAULT_MISMATCH + FAULT_CRC + FAULT_FRAMING)
+                reply[0] = 0x86;
+
+            putRecord(out, time + 20000 + nextRandom() % 25000, (uint16_t)unit, MHZ19TRACE_RX, reply);
+        }
+    }
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int benchmark(unsigned long megabytes)
+{
+    std::vector<uint8_t> trace;
+
+    generate(trace, 256, megabytes * 1024 * 1024 / (2 * MHZ19TRACE_RECORD));
+
+    size_t count = trace.size() / MHZ19TRACE_RECORD;
+    double size = (double)trace.size() / 1e6;
+    MHZ19TraceUnit totals[2];
+
+    printf("%zu records, %.0f MB, 256 units\n", count, size);
+
+    for (int isScalar = 1; isScalar >= 0; isScalar--)
+    {
+        /* kernel alone */
+        std::vector<uint64_t> valid((count + 63) / 64);
+        auto start = std::chrono::steady_clock::now();
+        size_t good = mhz19TraceCheck(trace.data(), count, valid.data(), isScalar);
+        double kernel = secondsSince(start);
+
+        /* with the per-unit pass */
+        MHZ19TraceStats stats;
+        stats.setScalar(isScalar);
+
+        start = std::chrono::steady_clock::now();
+        stats.add(trace.data(), count);
+        stats.finish();
+        double full = secondsSince(start);
+
+        totals[isScalar] = stats.getTotal();
+
+        printf("%-8s kernel %7.0f MB/s (%zu valid), with per-unit summary %6.0f MB/s\n",
+               isScalar ? "portable" : "SSE2", size / kernel, good, size / full);
+    }
+
+    MHZ19TraceUnit &total = totals[0];
+    double exchanges = (double)total.requests;
+
+    printf("error rates: crc %.2f%% framing %.2f%% match %.2f%% lost %.2f%% (generated %.2f / %.2f / %.2f / %.2f)\n",
+           100 * total.crc / exchanges, 100 * total.framing / exchanges, 100 * total.mismatch / exchanges,
+           100 * total.unanswered / exchanges, FAULT_CRC / 100.0, FAULT_FRAMING / 100.0,
+           FAULT_MISMATCH / 100.0, FAULT_LOST / 100.0);
+
+    bool agree = !memcmp(&totals[0], &totals[1], sizeof(MHZ19TraceUnit));
+
+    /* generated rates are recovered within sampling error */
+    bool isRecovered = total.crc * 10000 / total.requests - FAULT_CRC + 10 <= 20
+                       && total.framing * 10000 / total.requests - FAULT_FRAMING + 10 <= 20
+                       && total.mismatch * 10000 / total.requests - FAULT_MISMATCH + 10 <= 20
+                       && total.unanswered * 10000 / total.requests - FAULT_LOST + 10 <= 20;
+
+    printf("%s\n", !agree ? "FAIL kernels disagree" : !isRecovered ? "FAIL rates not recovered" : "PASS");
+
+    return agree && isRecovered ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && !strcmp(argv[1], "-b"))
+        return benchmark(argc > 2 ? strtoul(argv[2], NULL, 10) : 256);
+
+    if (argc > 4 && !strcmp(argv[1], "-g"))
+    {
+        std::vector<uint8_t> trace;
+
+        generate(trace, (unsigned)atoi(argv[2]), strtoul(argv[3], NULL, 10));
+
+        FILE *file = fopen(argv[4], "wb");
+
+        if (!file || fwrite(trace.data(), 1, trace.size(), file) != trace.size())
+        {
+            fprintf(stderr, "cannot write %s\n", argv[4]);
+            return 1;
+        }
+
+        fclose(file);
+        return 0;
+    }
+
+    MHZ19TraceStats stats;
+    bool isErrorsOnly = false;
+    int files = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-e"))
+            isErrorsOnly = true;
+        else if (!strcmp(argv[i], "-s"))
+            stats.setScalar(true);
+        else if (!stats.addFile(argv[i]))
+        {
+            fprintf(stderr, "cannot read %s\n", argv[i]);
+            return 1;
+        }
+        else
+            files++;
+    }
+
+    if (!files)
+    {
+        fprintf(stderr, "usage: TraceScan [-e] [-s] trace.bin... | -g units exchanges trace.bin | -b [MB]\n");
+        return 1;
+    }
+
+    stats.finish();
+
+    double seconds = secondsSince(start);
+
+    stats.print(stdout, isErrorsOnly);
+
+    fprintf(stderr, "%llu records in %.3fs, %.0f MB/s\n", (unsigned long long)stats.getRecords(), seconds,
+            stats.getRecords() * MHZ19TRACE_RECORD / 1e6 / seconds);
+
+    return 0;
+}
@@ -1,6 +1,27 @@
 /*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
 
 #include "MHZ19.h"
+#include "MHZ19PWM.h"
+
+#if defined (__AVR__)
+#include <util/atomic.h>
+#endif
+
+/* error events compile away entirely when MHZ19_ERRORS is 0 */
+#if MHZ19_ERRORS
+#define MHZ19_EVENT(code, arg) logEvent(code, arg)
+#define MHZ19_RESULT(result) logResult(result)
+#else
+#define MHZ19_EVENT(code, arg) ((void)0)
+#define MHZ19_RESULT(result) ((void)0)
+#endif
+
+/* as do communication prints when MHZ19_ENABLE_PRINT is 0 */
+#if MHZ19_ENABLE_PRINT
+#define MHZ19_PRINT(bytes, isSent, code) do { if (this->storage.settings.printcomm) printstream(bytes, isSent, code); } while (0)
+#else
+#define MHZ19_PRINT(bytes, isSent, code) ((void)0)
+#endif
 
 /*#########################-Commands-##############################*/
 
@@ -35,11 +56,7 @@ int MHZ19::begin(Stream &serial)
     /* check if successful */
     if (this->errorCode != RESULT_OK)
     {
-        #if defined (ESP32) && (MHZ19_ERRORS)
-        ESP_LOGE(TAG_MHZ19, "Initial communication errorCode recieved");
-        #elif MHZ19_ERRORS
-        Serial.println("!ERROR: Initial communication errorCode recieved");
-        #endif
+        MHZ19_EVENT(EVENT_INIT, this->errorCode);
     }
 
     /* What FW version is the sensor running? */
@@ -48,6 +65,27 @@ int MHZ19::begin(Stream &serial)
 
     /* Store the major version number (assumed to be less than 10) */
     this->storage.settings.fw_ver = myVersion[1];
+    memcpy(this->storage.settings.version, myVersion, 4);
+    return 0;
+}
+
+int MHZ19::begin(Stream &serial, const MHZ19Identity &identity)
+{
+    if (identity.magic != MHZ19_IDENTITY_MAGIC || identity.crc != identityCRC(identity) || !identity.verified)
+    {
+        MHZ19_EVENT(EVENT_IDENTITY, RESULT_NULL);
+
+        return begin(serial);
+    }
+
+    mySerial = &serial;
+
+    /* trust the saved identity, the first reply confirms it */
+    memcpy(this->storage.settings.version, identity.version, 4);
+    this->storage.settings.fw_ver = identity.version[1];
+    this->storage.settings.verified = false;
+    this->storage.settings.lazyVerify = true;
+
     return 0;
 }
 
@@ -57,40 +95,61 @@ void MHZ19::setRange(int range)
 {
     if(range < 500 || range > 20000)
     {
-        #if defined (ESP32) && (MHZ19_ERRORS)
-        ESP_LOGE(TAG_MHZ19, "Invalid Range value (500 - 20000)");
-        #elif MHZ19_ERRORS
-        Serial.println("!ERROR: Invalid Range value (500 - 20000)");
-        #endif
+        MHZ19_EVENT(EVENT_RANGE, range);
 
         return;
     }
 
+    /* already held by the sensor */
+    else if (range == this->storage.shadow.range)
+        this->errorCode = RESULT_OK;
+
     else
+    {
         provisioning(RANGE, range);
+
+        if (this->errorCode == RESULT_OK)
+            this->storage.shadow.range = range;
+    }
 }
 
 void MHZ19::zeroSpan(int span)
 {
     if (span > 10000)
     {
-        #if defined (ESP32) && (MHZ19_ERRORS)
-        ESP_LOGE(TAG_MHZ19, "Invalid Span value (0 - 10000)");
-        #elif MHZ19_ERRORS
-        Serial.println("!ERROR: Invalid Span value (0 - 10000)");
-        #endif
+        MHZ19_EVENT(EVENT_SPAN, span);
     }
     else
+    {
+        /* calibrates against the gas present, so always sent, the shadow only records it */
         provisioning(SPANCAL, span);
 
+        if (this->errorCode == RESULT_OK)
+            this->storage.shadow.span = span;
+    }
+
     return;
 }
 
+#if MHZ19_ENABLE_FILTER
 void MHZ19::setFilter(bool isON, bool isCleared)
 {
     this->storage.settings.filterMode = isON;
     this->storage.settings.filterCleared = isCleared;
 }
+#endif
+
+#if MHZ19_ENABLE_PREFETCH
+void MHZ19::setPrefetch(bool isON, unsigned long maxAge)
+{
+    /* collect any outstanding reply so the stream stays in sync */
+    if (!isON)
+        drainPrefetch();
+
+    this->storage.settings.prefetch = isON;
+    this->storage.settings.prefetchAge = maxAge;
+}
+#endif
 
 /*########################-Get Functions-##########################*/
 
@@ -106,7 +165,9 @@ int MHZ19::getCO2(bool isunLimited, bool force)
 
     if (this->errorCode == RESULT_OK || force == false)
     {
+#if MHZ19_ENABLE_FILTER
         if (!this->storage.settings.filterMode)
+#endif
         {
             unsigned int validRead = 0;
 
@@ -119,19 +180,30 @@ int MHZ19::getCO2(bool isunLimited, bool force)
                 validRead = 32767;  // Set to maximum to stop negative values being return due to overflow
 
             else
-                 return validRead;
+                 return force ? sample(validRead) : validRead;
         }
+#if MHZ19_ENABLE_FILTER
         else
         {
            /* FILTER BEGIN ----------------------------------------------------------- */
             unsigned int checkVal[2];
             bool trigFilter = false;
 
-            // Filter must call the opposest unlimited/limited command to work
-            if(!isunLimited)
-                provisioning(CO2UNLIM);
-            else
-                provisioning(CO2LIM);
+            // Filter must call the opposest unlimited/limited command to work, unless
+            // not forced, when both last replies are checked without communicating
+            if (force == true)
+            {
+                if(!isunLimited)
+                    provisioning(CO2UNLIM);
+                else
+                    provisioning(CO2LIM);
+
+#if MHZ19_ENABLE_PREFETCH
+                /* held back by provisioning() until both requests were answered */
+                if (this->storage.settings.prefetch && !this->storage.settings.inFlight && this->errorCode == RESULT_OK)
+                    sendPrefetch();
+#endif
+            }
 
             checkVal[0] = makeInt(this->storage.responses.CO2UNLIM[4], this->storage.responses.CO2UNLIM[5]);
             checkVal[1] = makeInt(this->storage.responses.CO2LIM[2], this->storage.responses.CO2LIM[3]);
@@ -145,6 +217,7 @@ int MHZ19::getCO2(bool isunLimited, bool force)
                 if(checkVal[0] > 32767 || checkVal[1] > 32767 || (((checkVal[0] - checkVal[1]) >= 10) && checkVal[1] == 410))
                 {
                     this->errorCode = RESULT_FILTER;
+                    MHZ19_RESULT(RESULT_FILTER);
                     return 0;
                 }
             }
@@ -166,19 +239,22 @@ int MHZ19::getCO2(bool isunLimited, bool force)
                 if(trigFilter)
                 {
                     this->errorCode = RESULT_FILTER;
+                    MHZ19_RESULT(RESULT_FILTER);
                 }
             }
 
-            if(isunLimited)
-                return checkVal[0];
-            else
-                return checkVal[1];
+            if(this->errorCode != RESULT_OK || force == false)
+                return isunLimited ? checkVal[0] : checkVal[1];
+
+            return sample(isunLimited ? checkVal[0] : checkVal[1]);
             /* FILTER END ----------------------------------------------------------- */
         }
+#endif
     }
     return 0;
 }
 
+#if MHZ19_ENABLE_RAW
 unsigned int MHZ19::getCO2Raw(bool force)
 {
     if (force == true)
@@ -207,7 +283,29 @@ float MHZ19::getTransmittance(bool force)
         return 0;
 }
 
+unsigned int MHZ19::getTransmittanceBp(bool force)
+{
+    if (force == true)
+        provisioning(RAWCO2);
+
+    if (this->errorCode == RESULT_OK || force == false)
+    {
+        unsigned long calc = makeInt(this->storage.responses.RAW[2], this->storage.responses.RAW[3]);
+
+        return (unsigned int)(calc * 2 / 7); // calc * 10000 (to basis points) / 35000 (x(raw) zero)
+    }
+
+    else
+        return 0;
+}
+#endif
+
 float MHZ19::getTemperature(bool force)
+{
+    return (float)getTemperatureCenti(force) / 100;
+}
+
+int MHZ19::getTemperatureCenti(bool force)
 {
     if(this->storage.settings.fw_ver < 5)
     {
@@ -215,18 +313,18 @@ float MHZ19::getTemperature(bool force)
             provisioning(CO2LIM);
 
         if (this->errorCode == RESULT_OK || force == false)
-            return (this->storage.responses.CO2LIM[4] - TEMP_ADJUST);
+            return ((int)this->storage.responses.CO2LIM[4] - TEMP_ADJUST) * 100;
     }
     else
     {
         if (force == true)
             provisioning(CO2UNLIM);
 
-        if (this->errorCode == RESULT_OK)
-            return (float)(((int)this->storage.responses.CO2UNLIM[2] << 8) | this->storage.responses.CO2UNLIM[3]) / 100;
+        if (this->errorCode == RESULT_OK || force == false)
+            return (int)(((unsigned int)this->storage.responses.CO2UNLIM[2] << 8) | this->storage.responses.CO2UNLIM[3]);
     }
 
-    return -273.15;
+    return -27315;
 }
 
 int MHZ19::getRange()
@@ -235,8 +333,11 @@ int MHZ19::getRange()
     provisioning(GETRANGE);
 
     if (this->errorCode == RESULT_OK)
+    {
         /* convert MH-Z19 memory value and return */
-        return (int)makeInt(this->storage.responses.STAT[4], this->storage.responses.STAT[5]);
+        this->storage.shadow.range = (int)makeInt(this->storage.responses.STAT[4], this->storage.responses.STAT[5]);
+        return this->storage.shadow.range;
+    }
 
     else
         return 0;
@@ -258,8 +359,23 @@ byte MHZ19::getAccuracy(bool force)
 
 byte MHZ19::getPWMStatus()
 {
-    //255 156 byte 4;
-    return 0;
+    if (this->pwmReader == NULL)
+        return PWM_NONE;
+
+    return this->pwmReader->getStatus();
+}
+
+bool MHZ19::getIdentity(MHZ19Identity &identity)
+{
+    if (!this->storage.settings.version[0] && !this->storage.settings.version[1])
+        return false;
+
+    identity.magic = MHZ19_IDENTITY_MAGIC;
+    memcpy(identity.version, this->storage.settings.version, 4);
+    identity.verified = this->storage.settings.verified;
+    identity.crc = identityCRC(identity);
+
+    return true;
 }
 
 void MHZ19::getVersion(char rVersion[])
@@ -319,8 +435,16 @@ bool MHZ19::getABC()
     provisioning(GETABC);
 
     if (this->errorCode == RESULT_OK)
+    {
+        /* status only, keep a known period if the shadow agrees */
+        if (!this->storage.responses.STAT[7])
+            this->storage.shadow.ABC = MHZ19_ABC_PERIOD_OFF;
+        else if (this->storage.shadow.ABC == MHZ19_ABC_PERIOD_OFF || this->storage.shadow.ABC == MHZ19_CONFIG_UNKNOWN)
+            this->storage.shadow.ABC = MHZ19_CONFIG_ABC_ON;
+
         /* convert MH-Z19 memory value and return */
         return this->storage.responses.STAT[7];
+    }
     else
         return 1;
 }
@@ -329,7 +453,11 @@ bool MHZ19::getABC()
 
 int MHZ19::verify()
 {
-    unsigned long timeStamp = millis();
+#if MHZ19_ENABLE_PREFETCH
+    drainPrefetch();
+#endif
+
+    unsigned long timeStamp = clockNow();
 
     /* construct common command (133) */
     constructCommand(CO2UNLIM);
@@ -338,13 +466,9 @@ int MHZ19::verify()
 
     while (read(this->storage.responses.CO2UNLIM, CO2UNLIM) != RESULT_OK)
     {
-        if (millis() - timeStamp >= TIMEOUT_PERIOD)
+        if (clockNow() - timeStamp >= TIMEOUT_PERIOD)
         {
-           #if defined (ESP32) && (MHZ19_ERRORS)
-            ESP_LOGE(TAG_MHZ19, "Failed to verify connection(1) to sensor.");
-            #elif MHZ19_ERRORS
-            Serial.println("!ERROR: Failed to verify connection(1) to sensor.");
-            #endif
+            MHZ19_EVENT(EVENT_VERIFY, 1);
 
             return 1;
         }
@@ -355,17 +479,13 @@ int MHZ19::verify()
     write(this->storage.constructedCommand);
 
     /* update timeStamp  for next comms iteration */
-    timeStamp = millis();
+    timeStamp = clockNow();
 
     while (read(this->storage.responses.STAT, GETLASTRESP) != RESULT_OK)
     {
-        if (millis() - timeStamp >= TIMEOUT_PERIOD)
+        if (clockNow() - timeStamp >= TIMEOUT_PERIOD)
         {
-            #if defined (ESP32) && (MHZ19_ERRORS)
-            ESP_LOGE(TAG_MHZ19, "Failed to verify connection(2) to sensor.");
-            #elif MHZ19_ERRORS
-            Serial.println("!ERROR: Failed to verify connection(2) to sensor.");
-            #endif
+            MHZ19_EVENT(EVENT_VERIFY, 2);
 
             return 1;
         }
@@ -376,15 +496,14 @@ int MHZ19::verify()
     {
         if (this->storage.responses.CO2UNLIM[i] != this->storage.responses.STAT[i])
         {
-            #if defined (ESP32) && (MHZ19_ERRORS)
-            ESP_LOGE(TAG_MHZ19, "Last response is not as expected, verification failed.");
-            #elif MHZ19_ERRORS
-            Serial.println("!ERROR: Last response is not as expected, verification failed.");
-            #endif
+            MHZ19_EVENT(EVENT_VERIFY, 3);
 
             return 1;
         }
     }
+
+    this->storage.settings.verified = true;
+    this->storage.settings.lazyVerify = false;
     return 0;
 }
 
@@ -411,10 +530,80 @@ void MHZ19::autoCalibration(bool isON, byte ABCPeriod)
     else
         ABCPeriod = MHZ19_ABC_PERIOD_OFF;                      // Set command byte to Zero to match command format.
 
+    writeABC(isON, ABCPeriod);
+
+    /* OFF must be resent before the sensor's next ABC cycle */
+    this->ABCRepeatTimer = clockNow();
+
+    if (isON)
+        this->scheduler.stop(JOB_ABC);
+    else
+        this->scheduler.set(JOB_ABC, MHZ19_ABC_REPEAT, this->ABCRepeatTimer);
+}
+
+void MHZ19::writeABC(bool isON, byte ABCPeriod)
+{
     /* Update storage */
     this->storage.settings.ABCRepeat = !isON;  // Set to opposite, as repeat command is sent only when ABC is OFF.
 
+    /* a read back ON is taken to match the default period */
+    if (ABCPeriod == this->storage.shadow.ABC
+        || (this->storage.shadow.ABC == MHZ19_CONFIG_ABC_ON && ABCPeriod == MHZ19_ABC_PERIOD_DEF))
+    {
+        this->errorCode = RESULT_OK;
+        return;
+    }
+
     provisioning(ABC, ABCPeriod);
+
+    if (this->errorCode == RESULT_OK)
+        this->storage.shadow.ABC = ABCPeriod;
+}
+
+bool MHZ19::loadConfig()
+{
+    getRange();
+
+    if (this->errorCode != RESULT_OK)
+        return false;
+
+    getABC();
+
+    return this->errorCode == RESULT_OK;
+}
+
+void MHZ19::getConfig(MHZ19Config &config)
+{
+    config = this->storage.shadow;
+}
+
+void MHZ19::setConfig(const MHZ19Config &config)
+{
+    this->storage.shadow = config;
+}
+
+byte MHZ19::applyConfig(const MHZ19Config &config)
+{
+    byte writes = 0;
+
+    if (config.range && config.range != this->storage.shadow.range)
+    {
+        setRange(config.range);
+        writes++;
+    }
+
+    if (config.ABC != MHZ19_CONFIG_UNKNOWN && config.ABC != MHZ19_CONFIG_ABC_ON && config.ABC != this->storage.shadow.ABC)
+    {
+        writeABC(config.ABC != MHZ19_ABC_PERIOD_OFF, config.ABC);
+        writes++;
+
+        if (config.ABC == MHZ19_ABC_PERIOD_OFF)
+            this->scheduler.set(JOB_ABC, MHZ19_ABC_REPEAT, clockNow());
+        else
+            this->scheduler.stop(JOB_ABC);
+    }
+
+    return writes;
 }
 
 void MHZ19::calibrate()
@@ -425,18 +614,383 @@ void MHZ19::calibrate()
 void MHZ19::recoveryReset()
 {
     provisioning(RECOVER);
+
+    /* the sensor may come back with other settings, so nothing is known to be held */
+    this->storage.shadow.range = 0;
+    this->storage.shadow.span = 0;
+    this->storage.shadow.ABC = MHZ19_CONFIG_UNKNOWN;
+}
+
+void MHZ19::maintain()
+{
+    unsigned long now = clockNow();
+
+    if (!this->scheduler.isDue(now) || this->storage.settings.inMaintenance)
+        return;
+
+    /* jobs must not overwrite the result of the request they may follow */
+    byte savedCode = this->errorCode;
+    int8_t job;
+
+#if MHZ19_ENABLE_PREFETCH
+    bool wasInFlight = this->storage.settings.inFlight;
+#endif
+
+    this->storage.settings.inMaintenance = true;
+
+    while ((job = this->scheduler.next(now)) >= 0)
+        runJob(job);
+
+    this->storage.settings.inMaintenance = false;
+
+#if MHZ19_ENABLE_PREFETCH
+    /* the jobs' commands drained the prefetched request, so send the next one */
+    if (wasInFlight && !this->storage.settings.inFlight && this->storage.settings.prefetch)
+        sendPrefetch();
+#endif
+
+    this->errorCode = savedCode;
+}
+
+void MHZ19::autoMaintenance(bool isON)
+{
+    this->storage.settings.autoMaintain = isON;
+}
+
+void MHZ19::setVerifyPeriod(unsigned long period)
+{
+    this->scheduler.set(JOB_VERIFY, period, clockNow());
+}
+
+void MHZ19::setReadbackPeriod(unsigned long period)
+{
+    this->scheduler.set(JOB_READBACK, period, clockNow());
+}
+
+void MHZ19::setSamplePeriod(unsigned long period)
+{
+    this->storage.settings.sampleFlag = false;
+    this->scheduler.set(JOB_SAMPLE, period, clockNow());
+}
+
+bool MHZ19::sampleDue()
+{
+    maintain();
+
+    if (!this->storage.settings.sampleFlag)
+        return false;
+
+    this->storage.settings.sampleFlag = false;
+
+    return true;
 }
 
+unsigned long MHZ19::nextDeadline()
+{
+    unsigned long now = clockNow();
+
+    /* a sample already due is waiting to be taken */
+    if (this->storage.settings.sampleFlag)
+        return now;
+
+    unsigned long deadline = now + MHZ19_NO_DEADLINE;
+
+    if (this->scheduler.isActive() && (long)(this->scheduler.getNextDue() - deadline) < 0)
+        deadline = this->scheduler.getNextDue();
+
+#if MHZ19_ENABLE_ASYNC
+    if (this->storage.receiver.pending)
+    {
+        unsigned long reply = this->storage.receiver.timer + MHZ19_REPLY_TIME;
+
+        /* once the reply is late, its time out is next */
+        if ((long)(now - reply) >= 0)
+            reply = this->storage.receiver.timer + TIMEOUT_PERIOD;
+
+        if ((long)(reply - deadline) < 0)
+            deadline = reply;
+    }
+#endif
+
+    return deadline;
+}
+
+unsigned long MHZ19::untilDeadline()
+{
+    long remaining = (long)(nextDeadline() - clockNow());
+
+    return remaining > 0 ? (unsigned long)remaining : 0;
+}
+
+#if MHZ19_ENABLE_ASYNC
+bool MHZ19::requestCO2(bool isunLimited)
+{
+    return request(isunLimited ? CO2UNLIM : CO2LIM);
+}
+
+#if MHZ19_ENABLE_RAW
+bool MHZ19::requestRaw()
+{
+    return request(RAWCO2);
+}
+#endif
+
+bool MHZ19::receive()
+{
+    volatile byte *busy = &this->storage.receiver.busy;
+
+    if (!this->storage.receiver.pending)
+        return false;
+
+    /* a UART event task and loop() can both be here, only one reads the stream and frame */
+#if defined (__AVR__)
+    bool isFree;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { isFree = !*busy; *busy = 1; }
+
+    if (!isFree)
+        return false;
+
+    bool isDone = parseReceived();
+    *busy = 0;
+#else
+    if (__atomic_exchange_n(busy, 1, __ATOMIC_ACQUIRE))
+        return false;
+
+    bool isDone = parseReceived();
+    __atomic_store_n(busy, 0, __ATOMIC_RELEASE);
+#endif
+
+    return isDone;
+}
+
+bool MHZ19::parseReceived()
+{
+    /* pending may have ended in the other context since receive() looked */
+    if (!this->storage.receiver.pending)
+        return false;
+
+    byte discarded = 0;
+
+    while (mySerial->available())
+    {
+        byte in = mySerial->read();
+
+        /* frames start with 0xFF, anything before one is out of step */
+        if (!this->storage.receiver.count && in != 0xFF)
+        {
+            discarded++;
+            continue;
+        }
+
+        this->storage.receiver.frame[this->storage.receiver.count++] = in;
+
+        if (this->storage.receiver.count < MHZ19_DATA_LEN)
+            continue;
+
+        if (this->storage.receiver.frame[8] != getCRC(this->storage.receiver.frame))
+        {
+            MHZ19_EVENT(EVENT_CRC, this->storage.receiver.command);
+            this->storage.receiver.error = RESULT_CRC;
+
+            /* resync from the next 0xFF held, if any */
+            byte shift = 1;
+            while (shift < MHZ19_DATA_LEN && this->storage.receiver.frame[shift] != 0xFF)
+                shift++;
+
+            memmove(this->storage.receiver.frame, this->storage.receiver.frame + shift, MHZ19_DATA_LEN - shift);
+            this->storage.receiver.count = MHZ19_DATA_LEN - shift;
+            discarded += shift;
+            continue;
+        }
+
+        /* a stale reply to an earlier request, keep waiting for this one */
+        if (this->storage.receiver.frame[1] != this->storage.receiver.command)
+        {
+            MHZ19_EVENT(EVENT_MATCH, this->storage.receiver.command);
+            this->storage.receiver.error = RESULT_MATCH;
+            this->storage.receiver.count = 0;
+            discarded += MHZ19_DATA_LEN;
+            continue;
+        }
+
+        if (discarded)
+            MHZ19_EVENT(EVENT_CLEARED, discarded);
+
+        finishFrame(RESULT_OK);
+        return true;
+    }
+
+    if (discarded)
+        MHZ19_EVENT(EVENT_CLEARED, discarded);
+
+    if (clockNow() - this->storage.receiver.timer >= TIMEOUT_PERIOD)
+    {
+        MHZ19_EVENT(EVENT_TIMEOUT, this->storage.receiver.command);
+
+        /* a CRC or match failure explains the time out better */
+        finishFrame(this->storage.receiver.error != RESULT_NULL ? this->storage.receiver.error : (byte)RESULT_TIMEOUT);
+        return true;
+    }
+
+    return false;
+}
+#endif
+
+#if MHZ19_ENABLE_PRINT
 void MHZ19::printCommunication(bool isDec, bool isPrintComm)
 {
     this->storage.settings._isDec = isDec;
     this->storage.settings.printcomm = isPrintComm;
 }
+#endif
+
+/*######################-Event Functions-##########################*/
+
+#if MHZ19_ERRORS
+bool MHZ19::getEvent(MHZ19Event &event)
+{
+    if (!this->events.count)
+        return false;
+
+    event = this->events.ring[this->events.head];
+
+    this->events.head = (this->events.head + 1) & (MHZ19_EVENT_DEPTH - 1);
+    this->events.count--;
+
+    return true;
+}
+
+void MHZ19::printEvent(Print &out, const MHZ19Event &event)
+{
+    const __FlashStringHelper *text;
+
+    /* text only lives in flash, and only once for all events */
+    switch (event.code)
+    {
+    case EVENT_INIT:
+        text = F("Initial communication failed, errorCode: ");
+        break;
+    case EVENT_RANGE:
+        text = F("Invalid Range value (500 - 20000): ");
+        break;
+    case EVENT_SPAN:
+        text = F("Invalid Span value (0 - 10000): ");
+        break;
+    case EVENT_VERIFY:
+        text = F("Failed to verify connection to sensor, stage: ");
+        break;
+    case EVENT_TIMEOUT:
+        text = F("Timed out waiting for response, command: ");
+        break;
+    case EVENT_MATCH:
+        text = F("Response did not match request, command: ");
+        break;
+    case EVENT_CRC:
+        text = F("Response failed CRC, command: ");
+        break;
+    case EVENT_CLEARED:
+        text = F("Bytes cleared for desync correction: ");
+        break;
+    case EVENT_READ_RANGE:
+        text = F("Range read back differs from range set: ");
+        break;
+    case EVENT_READ_ABC:
+        text = F("ABC read back as ON while set OFF, resent OFF: ");
+        break;
+    case EVENT_IDENTITY:
+        text = F("Saved identity rejected or not confirmed, errorCode: ");
+        break;
+    default:
+        text = F("Unknown event: ");
+        break;
+    }
+
+    out.print(event.timeStamp);
+    out.print(F(" ms !"));
+    out.print(text);
+    out.println(event.arg);
+}
+
+byte MHZ19::getHistory(byte codes[], byte len)
+{
+    if (len > this->stats.count)
+        len = this->stats.count;
+
+    byte slot = this->stats.head;
+
+    for (byte i = 0; i < len; i++)
+    {
+        codes[i] = this->stats.history[slot];
+        slot = slot ? slot - 1 : MHZ19_HISTORY_DEPTH - 1;
+    }
+
+    return len;
+}
+
+void MHZ19::resetStats()
+{
+    memset(this->stats.results, 0, sizeof(this->stats.results));
+    this->stats.head = 0;
+    this->stats.count = 0;
+}
+
+void MHZ19::logEvent(byte code, int arg)
+{
+    byte slot = (this->events.head + this->events.count) & (MHZ19_EVENT_DEPTH - 1);
+
+    /* when full, overwrite the oldest */
+    if (this->events.count == MHZ19_EVENT_DEPTH)
+    {
+        this->events.head = (this->events.head + 1) & (MHZ19_EVENT_DEPTH - 1);
+
+        if (this->events.dropped < 255)
+            this->events.dropped++;
+    }
+    else
+        this->events.count++;
+
+    this->events.ring[slot].code = code;
+    this->events.ring[slot].arg = arg;
+    this->events.ring[slot].timeStamp = clockNow();
+}
+
+void MHZ19::logResult(byte result)
+{
+    if (result <= RESULT_FILTER)
+        this->stats.results[result]++;
+
+    this->stats.head = (this->stats.head + 1) % MHZ19_HISTORY_DEPTH;
+    this->stats.history[this->stats.head] = result;
+
+    if (this->stats.count < MHZ19_HISTORY_DEPTH)
+        this->stats.count++;
+}
+#endif
 
 /*######################-Inernal Functions-########################*/
 
 void MHZ19::provisioning(Command_Type commandtype, int inData)
 {
+#if MHZ19_ENABLE_ASYNC
+    /* a non-blocking request must finish before its reply could be taken for this one */
+    drainRequest();
+#endif
+
+#if MHZ19_ENABLE_PREFETCH
+    /* serve command 133 from the prefetched reply, otherwise it is only cleared out of the way */
+    if (drainPrefetch() && commandtype == CO2UNLIM)
+    {
+        /* maintenance first, its commands would otherwise drain the next request */
+        if (this->storage.settings.autoMaintain)
+            maintain();
+
+        if (isPrefetchSent())
+            sendPrefetch();
+
+        return;
+    }
+#endif
+
     /* construct command */
     constructCommand(commandtype, inData);
 
@@ -446,8 +1000,189 @@ void MHZ19::provisioning(Command_Type commandtype, int inData)
     /*return response */
     handleResponse(commandtype);
 
-    /* Check if ABC_OFF needs to run */
-    ABCCheck();
+    /* after a fast begin, the first reply stands in for verify() */
+    if (this->storage.settings.lazyVerify)
+    {
+        if (this->errorCode == RESULT_OK)
+        {
+            this->storage.settings.verified = true;
+            this->storage.settings.lazyVerify = false;
+        }
+        else
+            MHZ19_EVENT(EVENT_IDENTITY, this->errorCode);
+    }
+
+    /* run due maintenance, unless left to the application's idle points */
+    if (this->storage.settings.autoMaintain)
+        maintain();
+
+#if MHZ19_ENABLE_PREFETCH
+    /* keep the next reading on its way, after maintenance so it is not drained by it */
+    if (isPrefetchSent() && commandtype == CO2UNLIM && this->errorCode == RESULT_OK)
+        sendPrefetch();
+#endif
+}
+
+#if MHZ19_ENABLE_PREFETCH
+bool MHZ19::drainPrefetch()
+{
+    if (!this->storage.settings.inFlight)
+        return false;
+
+    byte frame[MHZ19_DATA_LEN];
+
+    this->storage.settings.inFlight = false;
+
+    /* rebuild the request so the reply is matched against it. read() clears its buffer before
+     * waiting, so a drain which fails must not be given the last good reading
+     */
+    constructCommand(CO2UNLIM);
+
+    if (read(frame, CO2UNLIM) != RESULT_OK || this->errorCode != RESULT_OK)
+        return false;
+
+    memcpy(this->storage.responses.CO2UNLIM, frame, MHZ19_DATA_LEN);
+
+    /* too old to serve as a current reading */
+    if (this->storage.settings.prefetchAge && clockNow() - this->storage.settings.prefetchTimer > this->storage.settings.prefetchAge)
+        return false;
+
+    return true;
+}
+
+bool MHZ19::isPrefetchSent()
+{
+#if MHZ19_ENABLE_FILTER
+    /* getCO2() sends it after the filter's second request, which would otherwise wait it out */
+    if (this->storage.settings.filterMode)
+        return false;
+#endif
+
+    return this->storage.settings.prefetch;
+}
+
+void MHZ19::sendPrefetch()
+{
+    constructCommand(CO2UNLIM);
+    write(this->storage.constructedCommand);
+
+    this->storage.settings.prefetchTimer = clockNow();
+    this->storage.settings.inFlight = true;
+}
+#endif
+
+#if MHZ19_ENABLE_ASYNC
+bool MHZ19::request(Command_Type commandtype)
+{
+    if (this->storage.receiver.pending)
+        return false;
+
+#if MHZ19_ENABLE_PREFETCH
+    /* collect any prefetched reply so it is not taken for this one */
+    drainPrefetch();
+#endif
+
+    constructCommand(commandtype);
+
+    /* armed before sending, a receive event may run as soon as the reply arrives */
+    this->storage.receiver.count = 0;
+    this->storage.receiver.error = RESULT_NULL;
+    this->storage.receiver.command = this->storage.constructedCommand[2];
+    this->storage.receiver.timer = clockNow();
+    this->storage.receiver.pending = true;
+
+    write(this->storage.constructedCommand);
+
+    return true;
+}
+
+void MHZ19::finishFrame(byte result)
+{
+    byte command = this->storage.receiver.command;
+
+    this->errorCode = result;
+
+    MHZ19_RESULT(result);
+
+    if (result == RESULT_OK)
+    {
+        byte *target = this->storage.responses.STAT;
+
+#if MHZ19_ENABLE_RAW
+        if (command == Commands[RAWCO2])
+            target = this->storage.responses.RAW;
+        else
+#endif
+        if (command == Commands[CO2UNLIM])
+            target = this->storage.responses.CO2UNLIM;
+        else if (command == Commands[CO2LIM])
+            target = this->storage.responses.CO2LIM;
+
+        memcpy(target, this->storage.receiver.frame, MHZ19_DATA_LEN);
+
+        if (this->storage.settings.lazyVerify)
+        {
+            this->storage.settings.verified = true;
+            this->storage.settings.lazyVerify = false;
+        }
+    }
+    else if (this->storage.settings.lazyVerify)
+        MHZ19_EVENT(EVENT_IDENTITY, result);
+
+    MHZ19_PRINT(this->storage.receiver.frame, false, result);
+
+    /* the frame is used, from here requestCO2() may rearm the receiver (e.g. from a callback) */
+    this->storage.receiver.pending = false;
+
+    if (this->frameCallback)
+        this->frameCallback(*this, command, result);
+
+    if (result != RESULT_OK || !this->sampleCallback)
+        return;
+
+    unsigned int ppm = 32768;
+
+    if (command == Commands[CO2UNLIM])
+        ppm = makeInt(this->storage.responses.CO2UNLIM[4], this->storage.responses.CO2UNLIM[5]);
+    else if (command == Commands[CO2LIM])
+        ppm = makeInt(this->storage.responses.CO2LIM[2], this->storage.responses.CO2LIM[3]);
+
+    /* overflowed readings are not served by getCO2() either */
+    if (ppm <= 32767)
+        sample(ppm);
+}
+#endif
+
+int MHZ19::sample(int ppm)
+{
+    if (this->sampleCallback)
+        this->sampleCallback(*this, ppm, this->sampleContext);
+
+    return ppm;
+}
+
+#if MHZ19_ENABLE_ASYNC
+void MHZ19::drainRequest()
+{
+    /* bounded by TIMEOUT_PERIOD within receive() */
+    while (this->storage.receiver.pending)
+    {
+        if (!receive())
+            yield();
+    }
+}
+#endif
+
+byte MHZ19::identityCRC(const MHZ19Identity &identity)
+{
+    /* same two's complement sum as getCRC() */
+    const byte *bytes = (const byte *)&identity;
+    byte crc = 0;
+
+    for (byte x = 0; x < offsetof(MHZ19Identity, crc); x++)
+        crc += bytes[x];
+
+    return 255 - crc + 1;
 }
 
 void MHZ19::constructCommand(Command_Type commandtype, int inData)
@@ -524,8 +1259,7 @@ void MHZ19::constructCommand(Command_Type commandtype, int inData)
 void MHZ19::write(byte toSend[])
 {
     /* for print communications */
-    if (this->storage.settings.printcomm == true)
-        printstream(toSend, true, this->errorCode);
+    MHZ19_PRINT(toSend, true, this->errorCode);
 
     /* transfer to buffer */
     mySerial->write(toSend, MHZ19_DATA_LEN);
@@ -536,8 +1270,11 @@ void MHZ19::write(byte toSend[])
 
 byte MHZ19::read(byte inBytes[MHZ19_DATA_LEN], Command_Type commandnumber)
 {
+    /* the reply is matched against constructedCommand, the command actually sent */
+    (void)commandnumber;
+
     /* loop escape */
-    unsigned long timeStamp = millis();
+    unsigned long timeStamp = clockNow();
 
     /* prepare memory array with unsigned chars of 0 */
     memset(inBytes, 0, MHZ19_DATA_LEN);
@@ -545,27 +1282,44 @@ byte MHZ19::read(byte inBytes[MHZ19_DATA_LEN], Command_Type commandnumber)
     /* prepare errorCode */
     this->errorCode = RESULT_NULL;
 
+    byte discarded = 0;
+
     /* wait until we have exactly the 9 bytes reply (certain controllers call read() too fast) */
-    while (mySerial->available() < MHZ19_DATA_LEN)
+    for (;;)
     {
-        if (millis() - timeStamp >= TIMEOUT_PERIOD)
+        /* bytes ahead of a start byte are left from an earlier desync, otherwise they would
+         * offset every following reply
+         */
+        while (mySerial->available() && mySerial->peek() != 0xFF && discarded < 255)
         {
-            #if defined (ESP32) && (MHZ19_ERRORS)
-            ESP_LOGW(TAG_MHZ19, "Timed out waiting for response");
-            #elif MHZ19_ERRORS
-            Serial.println("!Error: Timed out waiting for response");
-            #endif
+            mySerial->read();
+            discarded++;
+        }
+
+        if (mySerial->available() >= MHZ19_DATA_LEN)
+            break;
+
+        if (clockNow() - timeStamp >= TIMEOUT_PERIOD)
+        {
+            MHZ19_EVENT(EVENT_TIMEOUT, this->storage.constructedCommand[2]);
 
             this->errorCode = RESULT_TIMEOUT;
 
             /* clear incomplete 9 byte values, limit is finite */
             cleanUp(mySerial->available());
 
+            MHZ19_RESULT(RESULT_TIMEOUT);
+
             //return error condition
             return RESULT_TIMEOUT;
         }
+
+        yield();
     }
 
+    if (discarded)
+        MHZ19_EVENT(EVENT_CLEARED, discarded);
+
     /* response received, read buffer */
     mySerial->readBytes(inBytes, MHZ19_DATA_LEN);
 
@@ -586,41 +1340,42 @@ byte MHZ19::read(byte inBytes[MHZ19_DATA_LEN], Command_Type commandnumber)
         this->errorCode = RESULT_MATCH;
     }
 
+    if (this->errorCode == RESULT_CRC)
+        MHZ19_EVENT(EVENT_CRC, this->storage.constructedCommand[2]);
+    else if (this->errorCode == RESULT_MATCH)
+        MHZ19_EVENT(EVENT_MATCH, this->storage.constructedCommand[2]);
+
     /* if error has been assigned */
     if (this->errorCode == RESULT_NULL)
         this->errorCode = RESULT_OK;
 
+    MHZ19_RESULT(this->errorCode);
+
     /* print results */
-    if (this->storage.settings.printcomm == true)
-        printstream(inBytes, false, this->errorCode);
+    MHZ19_PRINT(inBytes, false, this->errorCode);
 
     return this->errorCode;
 }
 
 void MHZ19::cleanUp(uint8_t cnt)
 {
+    /* one event for the whole discard, rather than one per byte */
+    if (cnt)
+        MHZ19_EVENT(EVENT_CLEARED, cnt);
+
     for(uint8_t x = 0; x < cnt; x++)
-    {
-#if (MHZ19_ERRORS) // to avoid nasty ESP32 compiler error.
-        uint8_t eject = mySerial->read();
-#else
         mySerial->read();
-#endif
-#if defined (ESP32) && (MHZ19_ERRORS)
-        ESP_LOGW(TAG_MHZ19, "Clearing Byte: %d", eject);
-#elif MHZ19_ERRORS
-        Serial.print("!Warning: Clearing Byte: ");
-        Serial.println(eject);
-#endif
-    }
 }
 
 void MHZ19::handleResponse(Command_Type commandtype)
 {
+#if MHZ19_ENABLE_RAW
     if (this->storage.constructedCommand[2] == Commands[RAWCO2])	// compare commands byte
         read(this->storage.responses.RAW, commandtype);				// returns error number, passes back response and inputs command
 
-    else if (this->storage.constructedCommand[2] == Commands[CO2UNLIM])
+    else
+#endif
+    if (this->storage.constructedCommand[2] == Commands[CO2UNLIM])
         read(this->storage.responses.CO2UNLIM, commandtype);
 
     else if (this->storage.constructedCommand[2] == Commands[CO2LIM])
@@ -630,6 +1385,7 @@ void MHZ19::handleResponse(Command_Type commandtype)
         read(this->storage.responses.STAT, commandtype);
 }
 
+#if MHZ19_ENABLE_PRINT
 void MHZ19::printstream(byte inBytes[MHZ19_DATA_LEN], bool isSent, byte pserrorCode)
 {
     if (pserrorCode != RESULT_OK && isSent == false)
@@ -686,6 +1442,7 @@ void MHZ19::printstream(byte inBytes[MHZ19_DATA_LEN], bool isSent, byte pserrorC
         Serial.println(" ");
     }
 }
+#endif
 
 byte MHZ19::getCRC(byte inBytes[])
 {
@@ -703,17 +1460,49 @@ byte MHZ19::getCRC(byte inBytes[])
     return crc;
 }
 
-void MHZ19::ABCCheck()
+void MHZ19::runJob(byte job)
 {
-	/* check timer interval if dynamic hours have passed and if ABC_OFF was set to true */
-	if (((millis() - ABCRepeatTimer) >= 4.32e7) && (this->storage.settings.ABCRepeat == true))
-	{
-		/* update timer inerval */
-		ABCRepeatTimer = millis();
+    switch (job)
+    {
+    case JOB_ABC:
+        /* skip the next ABC cycle */
+        if (this->storage.settings.ABCRepeat == true)
+        {
+            this->ABCRepeatTimer = clockNow();
+            provisioning(ABC, MHZ19_ABC_PERIOD_OFF);
+
+            if (this->errorCode == RESULT_OK)
+                this->storage.shadow.ABC = MHZ19_ABC_PERIOD_OFF;
+        }
+        break;
+
+    case JOB_VERIFY:
+        verify();
+        break;
+
+    case JOB_SAMPLE:
+        this->storage.settings.sampleFlag = true;
+        break;
+
+    case JOB_READBACK:
+    {
+        /* readback refreshes the shadow, compare against what it held */
+        int expected = this->storage.shadow.range;
+        int range = getRange();
+
+        if (this->errorCode == RESULT_OK && expected && range != expected)
+            MHZ19_EVENT(EVENT_READ_RANGE, range);
 
-		/* construct command to skip next ABC cycle */
-		provisioning(ABC, MHZ19_ABC_PERIOD_OFF);
-	}
+        bool isABC = getABC();
+
+        if (this->errorCode == RESULT_OK && isABC && this->storage.settings.ABCRepeat == true)
+        {
+            MHZ19_EVENT(EVENT_READ_ABC, 1);
+            writeABC(false, MHZ19_ABC_PERIOD_OFF);
+        }
+        break;
+    }
+    }
 }
 
 void MHZ19::makeByte(int inInt, byte *high, byte *low)
@@ -4,22 +4,61 @@
 #define MHZ19_H
 
 #include <Arduino.h>
+#include "MHZ19Scheduler.h"
 
-#ifdef ESP32
-#include "esp32-hal-log.h"
-#define TAG_MHZ19 "MH-Z19"
+#ifndef MHZ19_ERRORS
+#define MHZ19_ERRORS 1			// Set to 0 to compile out the error event ring
 #endif
 
-#define MHZ19_ERRORS 1			// Set to 0 to disable error prints
+/* Features compiled in. Each is on every request's path, so stays in the build even when unused.
+ * Set to 0 with a build flag (e.g. -DMHZ19_ENABLE_PRINT=0, see extras/Host/SizeReport), the
+ * functions remain as stubs which do nothing and return 0 / false
+ */
+#ifndef MHZ19_ENABLE_PRINT
+#define MHZ19_ENABLE_PRINT 1		// printCommunication(), and with it the use of Serial
+#endif
+#ifndef MHZ19_ENABLE_FILTER
+#define MHZ19_ENABLE_FILTER 1		// setFilter()
+#endif
+#ifndef MHZ19_ENABLE_PREFETCH
+#define MHZ19_ENABLE_PREFETCH 1		// setPrefetch()
+#endif
+#ifndef MHZ19_ENABLE_ASYNC
+#define MHZ19_ENABLE_ASYNC 1		// requestCO2(), receive(), onFrame() (MHZ19Mux.h fails to compile without)
+#endif
+#ifndef MHZ19_ENABLE_RAW
+#define MHZ19_ENABLE_RAW 1			// getCO2Raw(), getTransmittance() and their response buffer
+#endif
+
+#define MHZ19_EVENT_DEPTH 8		// Error events held until drained (power of 2)
+#define MHZ19_HISTORY_DEPTH 16	// errorCode of recent replies kept for getHistory()
 #define TEMP_ADJUST 40			// This is the value used to adjust the temperature.
 #define TIMEOUT_PERIOD 500		// Time out period for response (ms)
 #define DEFAULT_RANGE 2000		// For range function (sensor works best in this range)
 #define MHZ19_DATA_LEN 9		// Data protocol length
+#define MHZ19_ABC_REPEAT 43200000UL	// Interval for resending ABC OFF (ms, 12 hours)
+#define MHZ19_IDENTITY_MAGIC 0x19	// Marks a saved MHZ19Identity as valid
+#define MHZ19_CONFIG_UNKNOWN 0xFF	// MHZ19Config ABC value when unknown
+#define MHZ19_CONFIG_ABC_ON 0xFE	// MHZ19Config ABC value when ON with an unknown period (read back)
+#define MHZ19_REPLY_TIME 40		// Time for a complete reply after a request (ms), see nextDeadline()
+#define MHZ19_NO_DEADLINE 0x7FFFFFFFUL	// untilDeadline() when nothing is scheduled (ms)
 
 // Command bytes -------------------------- //
 #define MHZ19_ABC_PERIOD_OFF    0x00
 #define MHZ19_ABC_PERIOD_DEF    0xA0
 
+class MHZ19PWM;
+class MHZ19;
+
+/* time source in ms, see setClock() */
+typedef unsigned long (*MHZ19Clock)();
+
+/* called by receive() when a requested frame completes, result is an ERRORCODE value */
+typedef void (*MHZ19FrameCallback)(MHZ19 &sensor, byte command, byte result);
+
+/* called with each valid CO2 reading (ppm) received, context as given to onSample() */
+typedef void (*MHZ19SampleCallback)(MHZ19 &sensor, int ppm, void *context);
+
 /* enum alias for error code definitions */
 enum ERRORCODE
 {
@@ -31,6 +70,48 @@ enum ERRORCODE
 	RESULT_FILTER = 5
 };
 
+/* enum alias for error event definitions, see getEvent() */
+enum ERROREVENT
+{
+	EVENT_NONE = 0,
+	EVENT_INIT = 1,				// Initial communication failed, arg: errorCode
+	EVENT_RANGE = 2,			// Invalid range requested, arg: range
+	EVENT_SPAN = 3,				// Invalid span requested, arg: span
+	EVENT_VERIFY = 4,			// Verification failed, arg: stage (1 - 3)
+	EVENT_TIMEOUT = 5,			// Timed out waiting for response, arg: command byte
+	EVENT_MATCH = 6,			// Response did not match request, arg: command byte
+	EVENT_CRC = 7,				// Response failed checksum, arg: command byte
+	EVENT_CLEARED = 8,			// Bytes discarded for desync correction, arg: count
+	EVENT_READ_RANGE = 9,		// Range read back differs from the one set, arg: range read
+	EVENT_READ_ABC = 10,		// ABC read back as ON while set OFF (OFF is resent), arg: 1
+	EVENT_IDENTITY = 11			// Saved identity rejected or first request after fast begin failed, arg: errorCode
+};
+
+/* device identity saved between boots (EEPROM, RTC memory..) for a fast begin() */
+struct MHZ19Identity
+{
+	byte magic;					// MHZ19_IDENTITY_MAGIC when valid
+	char version[4];			// firmware version, as from getVersion()
+	byte verified;				// 1 if communication had been verified
+	byte crc;					// checksum over the bytes above
+};
+
+/* sensor configuration shadowed by the library, see loadConfig() */
+struct MHZ19Config
+{
+	int range;					// range, 0 if unknown
+	int span;					// span last written, 0 if unknown (a record only, never rewritten)
+	byte ABC;					// ABC byte last written (0x00 OFF, period byte if ON), or MHZ19_CONFIG_ values
+};
+
+/* compact error record, text is only produced when printed */
+struct MHZ19Event
+{
+	byte code;					// ERROREVENT value
+	int arg;					// event argument (see ERROREVENT)
+	unsigned long timeStamp;	// millis() (or setClock() time) when recorded
+};
+
 class MHZ19
 {
   public:
@@ -39,14 +120,19 @@ class MHZ19
 	/* Holds last received error code from recieveResponse() */
 	byte errorCode;
 
-	/* for keeping track of the ABC run interval */
-	unsigned long ABCRepeatTimer;
+	/* clock time when ABC OFF was last sent (kept for compatibility, see maintain()) */
+	unsigned long ABCRepeatTimer = 0;
 
 	/*#####################-Initiation Functions-#####################*/
 
 	/* essential begin, return 0 on success, non-zero on error */
 	int begin(Stream &stream);
 
+	/* fast begin from a saved identity (see getIdentity()), returns without communicating.
+	 * Verification happens on the first request instead. An invalid identity runs begin(stream)
+	 */
+	int begin(Stream &stream, const MHZ19Identity &identity);
+
 	/*########################-Set Functions-##########################*/
 
 	/* Sets Range to desired value*/
@@ -55,23 +141,81 @@ class MHZ19
 	/* Sets Span to desired value below 10,000*/
 	void zeroSpan(int span = 2000);
 
+	/* Note: setRange() and autoCalibration() are skipped (errorCode RESULT_OK) when the shadow
+	 * configuration shows the sensor already holds the value, saving round-trips and writes.
+	 * zeroSpan() calibrates against the gas present, so it is always sent
+	 */
+
+#if MHZ19_ENABLE_FILTER
     /* Sets "filter mode" to ON or OFF & mode type (see example) */
 	void setFilter(bool isON = true, bool isCleared = true);
+#else
+	void setFilter(bool = true, bool = true) {};
+#endif
+
+#if MHZ19_ENABLE_PREFETCH
+	/* Keeps one CO2 request (command 133) in flight, so getCO2() is served from a reply
+	 * which already arrived. Replies older than maxAge (ms, 0 = any) are refreshed instead
+	 */
+	void setPrefetch(bool isON = true, unsigned long maxAge = 0);
+#else
+	void setPrefetch(bool = true, unsigned long = 0) {};
+#endif
+
+	/* replaces millis() as the time source (ms) for time outs, maintenance and deadlines,
+	 * e.g. with one which keeps counting through sleep. Set before begin(), NULL restores millis()
+	 */
+	void setClock(MHZ19Clock clock) { this->clock = clock; };
+
+	/* makes sampleDue() true every period ms, 0 (default) disables */
+	void setSamplePeriod(unsigned long period);
+
+#if MHZ19_ENABLE_ASYNC
+	/* Sets the function called when a frame from requestCO2() / requestRaw() completes */
+	void onFrame(MHZ19FrameCallback callback) { this->frameCallback = callback; };
+#else
+	void onFrame(MHZ19FrameCallback) {};
+#endif
+
+	/* Sets the function called with each valid CO2 reading, from getCO2() (force) and receive() (see MHZ19Alarm.h).
+	 * One function is held, setting another replaces it
+	 */
+	void onSample(MHZ19SampleCallback callback, void *context = NULL) { this->sampleCallback = callback; this->sampleContext = context; };
+
+	/* Associates a PWM reader (see MHZ19PWM.h) with this sensor for getPWMStatus() */
+	void setPWM(MHZ19PWM *reader) { this->pwmReader = reader; };
 
 	/*########################-Get Functions-##########################*/
 
 	/* request CO2 values, 2 types of CO2 can be returned, isLimted = true (command 134) and is Limited = false (command 133) */
 	int getCO2(bool isunLimited = true, bool force = true);
 
+#if MHZ19_ENABLE_RAW
 	/* returns the "raw" CO2 value of unknown units */
 	unsigned int getCO2Raw(bool force = true);
 
 	/* returns Raw CO2 value as a % of transmittance */		//<--- needs work to understand
 	float getTransmittance(bool force = true);
 
+	/* returns Raw CO2 value as transmittance in basis points (1/100 %), integer only */
+	unsigned int getTransmittanceBp(bool force = true);
+#else
+	unsigned int getCO2Raw(bool = true) { this->errorCode = RESULT_NULL; return 0; };
+	float getTransmittance(bool = true) { this->errorCode = RESULT_NULL; return 0; };
+	unsigned int getTransmittanceBp(bool = true) { this->errorCode = RESULT_NULL; return 0; };
+#endif
+
 	/*  returns temperature using command 133 or 134 */
 	float getTemperature(bool force = true);
 
+	/* returns temperature in hundredths of a degree C, integer only (-27315 on error) */
+	int getTemperatureCenti(bool force = true);
+
+	/* returns true when temperature comes in the CO2 unlimited (133) reply, firmware 5 and later,
+	 * so after getCO2() getTemperatureCenti(false) needs no request of its own
+	 */
+	bool isTemperatureWithCO2() { return this->storage.settings.fw_ver >= 5; };
+
 	/* reads range using command 153 */
 	int getRange();
 
@@ -81,7 +225,7 @@ class MHZ19
 	/* Returns accuracy value if available */
 	byte getAccuracy(bool force = true);
 
-	/* not yet implemented */
+	/* returns PWMSTATUS of the reader given to setPWM(), PWM_NONE (0) without one */
 	byte getPWMStatus();
 
 	/* returns MH-Z19 version using command 160, to the entered array */
@@ -96,6 +240,51 @@ class MHZ19
 	/* returns last recorded response from device using command 162 */
 	byte getLastResponse(byte bytenum);
 
+	/* reads range and ABC status into the shadow configuration, returns true on success */
+	bool loadConfig();
+
+	/* copies the shadow configuration, e.g. for saving */
+	void getConfig(MHZ19Config &config);
+
+	/* restores a saved shadow configuration without communicating */
+	void setConfig(const MHZ19Config &config);
+
+	/* writes only the range and ABC of config when known and differing from the shadow, returns writes made.
+	 * Span is a calibration, so it is not replayed
+	 */
+	byte applyConfig(const MHZ19Config &config);
+
+	/* fills identity for saving, returns false if the firmware version is not yet known */
+	bool getIdentity(MHZ19Identity &identity);
+
+	/* returns true once communication has been verified, by verify() or a first valid reply after a fast begin */
+	bool isVerified() { return this->storage.settings.verified; };
+
+	/* returns the current time (ms) from the clock given to setClock(), millis() without one */
+	unsigned long getClock() { return clockNow(); };
+
+	/* returns the function and context given to onSample(), e.g. to chain another after it */
+	MHZ19SampleCallback getSampleCallback() { return this->sampleCallback; };
+	void *getSampleContext() { return this->sampleContext; };
+
+	/* returns when (clock ms) the library next needs the CPU: an awaited reply, a sample or maintenance
+	 * falling due. Nothing scheduled gives MHZ19_NO_DEADLINE from now
+	 */
+	unsigned long nextDeadline();
+
+	/* returns ms until nextDeadline(), 0 if already due (e.g. to sleep for) */
+	unsigned long untilDeadline();
+
+	/* returns true while a requestCO2() / requestRaw() reply is awaited */
+#if MHZ19_ENABLE_ASYNC
+	bool isPending() { return this->storage.receiver.pending; };
+#else
+	bool isPending() { return false; };
+#endif
+
+	/* returns the command byte of the last request sent (e.g. 0x85), without communicating */
+	byte getLastCommand() { return this->storage.constructedCommand[2]; };
+
 	/*######################-Utility Functions-########################*/
 
 	/* ensure communication is working (included in begin())
@@ -112,11 +301,96 @@ class MHZ19
 	/*  Calibrate Backwards compatibility */
 	void inline calibrateZero(){ calibrate(); };
 
-	/* requests a reset */
+	/* requests a reset, after which the shadow configuration is unknown */
 	void recoveryReset();
 
+	/* runs due maintenance, then returns true once per setSamplePeriod(). Call on waking at nextDeadline() */
+	bool sampleDue();
+
+	/* runs due maintenance (ABC OFF resend, periodic verify & readback), call at idle points.
+	 * Costs a single compare when nothing is due
+	 */
+	void maintain();
+
+	/* isON (default) also runs due maintenance straight after requests, OFF leaves it to maintain().
+	 * ON keeps the behaviour of earlier versions, where the ABC OFF resend ran inside getCO2() etc.,
+	 * so sketches which never call maintain() still skip ABC. The cost is that a read which finds
+	 * jobs due blocks for their commands too (a readback adds two). Latency sensitive sketches
+	 * should turn it OFF and call maintain() at idle points
+	 */
+	void autoMaintenance(bool isON = true);
+
+	/* runs verify() every period ms from maintain(), 0 (default) disables. Blocks maintain() for
+	 * two round trips, up to 2 x TIMEOUT_PERIOD (also inside MHZ19Mux::update())
+	 */
+	void setVerifyPeriod(unsigned long period);
+
+	/* reads back range and ABC status every period ms from maintain(), 0 (default) disables.
+	 * Blocks as setVerifyPeriod(), plus one more round trip when ABC must be turned OFF again
+	 */
+	void setReadbackPeriod(unsigned long period);
+
+#if MHZ19_ENABLE_ASYNC
+	/* sends command 133 (isunLimited) or 134 without waiting, returns false if a reply is still awaited.
+	 * The reply is collected by receive(), then read with getCO2(isunLimited, false)
+	 */
+	bool requestCO2(bool isunLimited = true);
+
+	/* feeds waiting bytes to the frame parser without blocking, call from a UART receive event
+	 * (e.g. HardwareSerial::onReceive() on ESP32) and / or loop() so time outs are noticed.
+	 * Returns true when the awaited frame completed or timed out during this call.
+	 * Both may run at once: one parses and the other returns false, to be served on its next call
+	 */
+	bool receive();
+#else
+	bool requestCO2(bool = true) { return false; };
+	bool receive() { return false; };
+#endif
+
+#if MHZ19_ENABLE_ASYNC && MHZ19_ENABLE_RAW
+	/* as requestCO2() for command 132, read with getCO2Raw(false) */
+	bool requestRaw();
+#else
+	bool requestRaw() { return false; };
+#endif
+
+#if MHZ19_ENABLE_PRINT
 	/* use to show communication between MHZ19 and  Device */
 	void printCommunication(bool isDec = true, bool isPrintComm = true);
+#else
+	void printCommunication(bool = true, bool = true) {};
+#endif
+
+	/*######################-Event Functions-##########################*/
+
+#if MHZ19_ERRORS
+	/* pops the oldest recorded error event, returns false if none are pending */
+	bool getEvent(MHZ19Event &event);
+
+	/* returns number of events overwritten before being drained */
+	byte getEventsDropped() { return this->events.dropped; };
+
+	/* prints an event as text (held in flash) to the given output */
+	void printEvent(Print &out, const MHZ19Event &event);
+
+	/* returns the number of replies which ended with result (ERRORCODE value).
+	 * Readings rejected by the filter count as RESULT_FILTER after their replies count as RESULT_OK
+	 */
+	unsigned long getResultCount(byte result) { return result <= RESULT_FILTER ? this->stats.results[result] : 0; };
+
+	/* copies errorCode of up to len recent replies, newest first, returns the number copied */
+	byte getHistory(byte codes[], byte len);
+
+	/* clears result counts and history */
+	void resetStats();
+#else
+	bool getEvent(MHZ19Event &) { return false; };
+	byte getEventsDropped() { return 0; };
+	void printEvent(Print &, const MHZ19Event &) {};
+	unsigned long getResultCount(byte) { return 0; };
+	byte getHistory(byte[], byte) { return 0; };
+	void resetStats() {};
+#endif
 
   private:
 	/*###########################-Variables-##########################*/
@@ -124,6 +398,33 @@ class MHZ19
 	/* pointer for Stream class to accept reference for hardware and software ports */
   Stream* mySerial;
 
+#if MHZ19_ENABLE_ASYNC
+	/* called when a requested frame completes */
+	MHZ19FrameCallback frameCallback = NULL;
+#endif
+
+	/* called with each valid CO2 reading */
+	MHZ19SampleCallback sampleCallback = NULL;
+	void *sampleContext = NULL;
+
+	/* time source, millis() when NULL */
+	MHZ19Clock clock = NULL;
+
+	/* optional PWM reader for the same sensor */
+	MHZ19PWM *pwmReader = NULL;
+
+	/* alias for maintenance jobs */
+	typedef enum MAINTENANCE_JOB
+	{
+		JOB_ABC = 0,			// 0 Resend ABC OFF
+		JOB_VERIFY = 1,			// 1 Periodic verify()
+		JOB_READBACK = 2,		// 2 Range & ABC readback
+		JOB_SAMPLE = 3			// 3 Sample period for sampleDue()
+	} Maintenance_Job;
+
+	/* recurring maintenance jobs */
+	MHZ19Scheduler scheduler;
+
   /* alias for command types */
 	typedef enum COMMAND_TYPE
 	{
@@ -149,30 +450,122 @@ class MHZ19
 		struct config
 		{
 			bool ABCRepeat = false;					// A flag which represents whether auto calibration ABC period was checked
+			bool autoMaintain = true;				// Run due maintenance straight after requests
+			bool inMaintenance = false;				// Guards against maintenance re-entering itself
+			bool sampleFlag = false;				// A sample period passed, cleared by sampleDue()
+#if MHZ19_ENABLE_FILTER
 			bool filterMode = false;				// Flag set by setFilter() to signify is "filter mode" was made active
 			bool filterCleared = true;				// Additional flag set by setFilter() to store which mode was selected
+#endif
+#if MHZ19_ENABLE_PRINT
 			bool printcomm = false;					// Communication print options
 			bool _isDec = true;						// Holds preference for communication printing
+#endif
 			uint8_t fw_ver = 0;                     // holds the major version of the firmware
+			char version[4] = { 0 };				// holds the full firmware version
+			bool verified = false;					// Communication was verified
+			bool lazyVerify = false;				// Fast begin, the first valid reply verifies
+#if MHZ19_ENABLE_PREFETCH
+			bool prefetch = false;					// Flag set by setPrefetch() to keep a request in flight
+			bool inFlight = false;					// A prefetched command 133 request awaits its reply
+			unsigned long prefetchAge = 0;			// Oldest prefetched reply which may be served (ms, 0 = any)
+			unsigned long prefetchTimer = 0;		// clock time when the prefetched request was sent
+#endif
 		} settings;
 
 		byte constructedCommand[MHZ19_DATA_LEN];	// holder for new commands which are to be sent
 
+		MHZ19Config shadow = { 0, 0, MHZ19_CONFIG_UNKNOWN };	// what the sensor is known to hold
+
+#if MHZ19_ENABLE_ASYNC
+		struct rxstate
+		{
+			byte frame[MHZ19_DATA_LEN];				// bytes of the frame being assembled
+			byte count = 0;							// bytes held in frame
+			byte error = RESULT_NULL;				// CRC / match failure seen while waiting, reported on time out
+			bool pending = false;					// a requestCO2() / requestRaw() reply is awaited
+			byte command = 0;						// command byte of the awaited reply
+			unsigned long timer = 0;				// clock time when the request was sent
+			volatile byte busy = 0;					// a context is parsing in receive()
+		} receiver;
+#endif
+
 		struct indata
 		{
 			byte CO2UNLIM[MHZ19_DATA_LEN];			// Holds command 133 response values "CO2 unlimited and temperature for unsigned"
 			byte CO2LIM[MHZ19_DATA_LEN];			// Holds command 134 response values "CO2 limited and temperature for signed"
+#if MHZ19_ENABLE_RAW
 			byte RAW[MHZ19_DATA_LEN];				// Holds command 132 response values "CO2 Raw"
+#endif
 			byte STAT[MHZ19_DATA_LEN];				// Holds other command response values such as range, background CO2 etc
 		} responses;
 
 	} storage;
 
+#if MHZ19_ERRORS
+	/* Error event ring, drained by getEvent() */
+	struct eventring
+	{
+		MHZ19Event ring[MHZ19_EVENT_DEPTH];
+		byte head = 0;							// index of oldest event
+		byte count = 0;							// events pending
+		byte dropped = 0;						// events overwritten (saturates at 255)
+	} events;
+
+	/* Result counts and recent errorCode history, see getResultCount() */
+	struct statistics
+	{
+		unsigned long results[RESULT_FILTER + 1] = { 0 };	// replies by ERRORCODE value
+		byte history[MHZ19_HISTORY_DEPTH];
+		byte head = 0;							// index of the newest entry
+		byte count = 0;							// entries held
+	} stats;
+#endif
+
 	/*######################-Internal Functions-########################*/
 
 	/* Coordinates  sending, constructing and receiving commands */
 	void provisioning(Command_Type commandtype, int inData = 0);
 
+	/* current time from the clock */
+	unsigned long clockNow() { return this->clock ? this->clock() : millis(); };
+
+#if MHZ19_ENABLE_ASYNC
+	/* Sends a request for receive() to collect */
+	bool request(Command_Type commandtype);
+
+	/* receive() while holding the receiver */
+	bool parseReceived();
+
+	/* Ends the awaited request with result, storing the frame when valid */
+	void finishFrame(byte result);
+
+	/* Waits out a requestCO2() / requestRaw() reply before a blocking command */
+	void drainRequest();
+#endif
+
+	/* Passes a valid CO2 reading to the sample callback, returns it */
+	int sample(int ppm);
+
+	/* Sends the ABC command byte unless the shadow shows it is already set */
+	void writeABC(bool isON, byte ABCPeriod);
+
+	/* Checksum for MHZ19Identity */
+	byte identityCRC(const MHZ19Identity &identity);
+
+#if MHZ19_ENABLE_PREFETCH
+	/* Receives an in-flight prefetched reply, returns true if it is valid and may be served.
+	 * A failed drain leaves the last command 133 reply as it was
+	 */
+	bool drainPrefetch();
+
+	/* true when provisioning() sends the next prefetch itself (getCO2() does in filter mode) */
+	bool isPrefetchSent();
+
+	/* Sends the next command 133 request without waiting for the reply */
+	void sendPrefetch();
+#endif
+
 	/* Constructs commands using command array and entered values */
 	void constructCommand(Command_Type commandtype, int inData = 0);
 
@@ -188,11 +581,13 @@ class MHZ19
 	/* Assigns response to the correct communication arrays */
 	void handleResponse(Command_Type commandtype);
 
+#if MHZ19_ENABLE_PRINT
 	/* prints sending / receiving messages if enabled */
 	void printstream(byte inbytes[9], bool isSent, byte pserrorCode);
+#endif
 
-	/* Checks whether time elapse for next ABC OFF cycle has occurred */
-	void ABCCheck();
+	/* Runs one maintenance job */
+	void runJob(byte job);
 
 	/* converts integers to bytes according to /256 and %256 */
 	void makeByte(int inInt, byte *high, byte *low);
@@ -200,6 +595,15 @@ class MHZ19
 	/* converts bytes to integers according to *256 and + value */
 	unsigned int makeInt(byte high, byte low);
 
+	/* discards cnt bytes from the receive buffer */
 	void cleanUp(uint8_t cnt);
+
+#if MHZ19_ERRORS
+	/* records an error event into the ring, overwriting the oldest when full */
+	void logEvent(byte code, int arg);
+
+	/* counts a reply result and adds it to the history */
+	void logResult(byte result);
+#endif
 };
 #endif
@@ -0,0 +1,136 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#include "MHZ19Alarm.h"
+
+/*#####################-Initiation Functions-#####################*/
+
+void MHZ19Alarm::attach(MHZ19 &sensor)
+{
+    detach();
+
+    /* a callback already set is kept, and called after this alarm */
+    this->chained = sensor.getSampleCallback();
+    this->chainedContext = sensor.getSampleContext();
+
+    this->sensor = &sensor;
+    this->sensor->onSample(onSample, this);
+}
+
+void MHZ19Alarm::detach()
+{
+    if (!this->sensor)
+        return;
+
+    /* put back what was chained, unless the callback has since been replaced */
+    if (this->sensor->getSampleCallback() == onSample && this->sensor->getSampleContext() == this)
+        this->sensor->onSample(this->chained, this->chainedContext);
+
+    this->sensor = NULL;
+    this->chained = NULL;
+    this->chainedContext = NULL;
+}
+
+/*########################-Set Functions-##########################*/
+
+int8_t MHZ19Alarm::addLevel(int ppm, int hysteresis, unsigned long holdTime)
+{
+    if (this->count >= MHZ19_ALARM_LEVELS)
+        return -1;
+
+    /* insertion, keeping thresholds ascending */
+    byte index = this->count;
+
+    while (index > 0 && this->levels[index - 1].ppm > ppm)
+    {
+        this->levels[index] = this->levels[index - 1];
+        index--;
+    }
+
+    this->levels[index].ppm = ppm;
+    this->levels[index].hysteresis = hysteresis < 0 ? 0 : hysteresis;
+    this->levels[index].holdTime = holdTime;
+    this->count++;
+
+    reset();
+
+    return index + 1;
+}
+
+/*######################-Utility Functions-########################*/
+
+byte MHZ19Alarm::update(int ppm)
+{
+    byte next = target(ppm);
+
+    if (next == this->level)
+    {
+        this->candidate = this->level;
+        return this->level;
+    }
+
+    unsigned long now = clockNow();
+
+    if (next != this->candidate)
+    {
+        this->candidate = next;
+        this->candidateTimer = now;
+    }
+
+    /* rising holds for the level entered, falling for the level left */
+    byte boundary = next > this->level ? next : this->level;
+
+    if (now - this->candidateTimer < this->levels[boundary - 1].holdTime)
+        return this->level;
+
+    byte previous = this->level;
+
+    this->level = next;
+    this->since = now;
+    this->transitions++;
+
+    if (this->callback)
+        this->callback(*this, this->level, previous, ppm);
+
+    return this->level;
+}
+
+void MHZ19Alarm::reset()
+{
+    this->level = 0;
+    this->candidate = 0;
+    this->since = clockNow();
+    this->transitions = 0;
+}
+
+/*######################-Internal Functions-########################*/
+
+byte MHZ19Alarm::target(int ppm)
+{
+    byte next = this->level;
+
+    while (next < this->count && ppm >= this->levels[next].ppm)
+        next++;
+
+    if (next != this->level)
+        return next;
+
+    while (next > 0 && ppm < this->levels[next - 1].ppm - this->levels[next - 1].hysteresis)
+        next--;
+
+    return next;
+}
+
+void MHZ19Alarm::onSample(MHZ19 &sensor, int ppm, void *context)
+{
+    MHZ19Alarm *alarm = static_cast<MHZ19Alarm *>(context);
+
+    alarm->update(ppm);
+
+    if (alarm->chained)
+        alarm->chained(sensor, ppm, alarm->chainedContext);
+}
+
+unsigned long MHZ19Alarm::clockNow()
+{
+    return this->sensor ? this->sensor->getClock() : millis();
+}
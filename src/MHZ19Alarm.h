@@ -0,0 +1,103 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#ifndef MHZ19_ALARM_H
+#define MHZ19_ALARM_H
+
+#include <Arduino.h>
+#include "MHZ19.h"
+
+#define MHZ19_ALARM_LEVELS 4			// Thresholds which can be set (fixed, no heap)
+
+class MHZ19Alarm;
+
+/* called on a change of alarm level, level 0 is below every threshold */
+typedef void (*MHZ19AlarmCallback)(MHZ19Alarm &alarm, byte level, byte previous, int ppm);
+
+/* Turns CO2 readings into alarm levels. Level n is reached when a reading is at
+ * or above the nth threshold, and left when below it by the hysteresis. A new
+ * level must hold for the threshold's hold time before it is taken, so
+ * readings hovering near a threshold cause no traffic. The callback is called
+ * on transitions only.
+ */
+class MHZ19Alarm
+{
+  public:
+	/*#####################-Initiation Functions-#####################*/
+
+	/* takes each valid reading from the sensor's sampling path (see MHZ19::onSample()), and its clock
+	 * (see MHZ19::setClock()). A sample callback already set is chained, called after this alarm
+	 */
+	void attach(MHZ19 &sensor);
+
+	/* stops taking readings from the sensor, restoring the chained callback. Detach alarms
+	 * attached to one sensor in the reverse order
+	 */
+	void detach();
+
+	/*########################-Set Functions-##########################*/
+
+	/* adds a threshold (ppm), left below ppm - hysteresis, taken after holding for holdTime (ms).
+	 * Thresholds are kept in ascending order, returns the new level or -1 when full. Resets the level to 0
+	 */
+	int8_t addLevel(int ppm, int hysteresis = 50, unsigned long holdTime = 0);
+
+	/* Sets the function called on a change of level */
+	void onChange(MHZ19AlarmCallback callback) { this->callback = callback; };
+
+	/*########################-Get Functions-##########################*/
+
+	/* current level, 0 - number of thresholds */
+	byte getLevel() { return this->level; };
+
+	/* threshold (ppm) of a level, 0 if not set */
+	int getThreshold(byte level) { return level && level <= this->count ? this->levels[level - 1].ppm : 0; };
+
+	/* clock time (ms) at the last change of level */
+	unsigned long getSince() { return this->since; };
+
+	/* changes of level since the last reset */
+	unsigned long getTransitions() { return this->transitions; };
+
+	/*######################-Utility Functions-########################*/
+
+	/* takes a reading (ppm) from elsewhere, returns the level */
+	byte update(int ppm);
+
+	/* returns to level 0 without a callback */
+	void reset();
+
+  private:
+	/*###########################-Variables-##########################*/
+
+	struct threshold
+	{
+		int ppm;
+		int hysteresis;
+		unsigned long holdTime;
+	} levels[MHZ19_ALARM_LEVELS];
+
+	byte count = 0;
+
+	MHZ19 *sensor = NULL;
+	MHZ19AlarmCallback callback = NULL;
+	MHZ19SampleCallback chained = NULL;		// sample callback set before attach()
+	void *chainedContext = NULL;
+
+	byte level = 0;
+	byte candidate = 0;						// level the readings point to, awaiting its hold time
+	unsigned long candidateTimer = 0;		// clock time when readings first pointed to candidate
+	unsigned long since = 0;
+	unsigned long transitions = 0;
+
+	/*######################-Internal Functions-########################*/
+
+	/* level the reading points to from the current level, hysteresis applied */
+	byte target(int ppm);
+
+	/* sample callback given to the sensor */
+	static void onSample(MHZ19 &sensor, int ppm, void *context);
+
+	/* the attached sensor's clock, millis() when detached */
+	unsigned long clockNow();
+};
+#endif
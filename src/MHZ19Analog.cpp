@@ -0,0 +1,146 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#include "MHZ19Analog.h"
+
+/*#####################-Initiation Functions-#####################*/
+
+void MHZ19Analog::begin(byte pin, byte oversampleBits, unsigned long sampleInterval)
+{
+    if (oversampleBits > MHZ19_ANALOG_MAX_BITS)
+        oversampleBits = MHZ19_ANALOG_MAX_BITS;
+
+    this->pin = pin;
+    this->bits = oversampleBits;
+    this->interval = sampleInterval;
+
+    this->accumulator = 0;
+    this->samples = 0;
+    this->hasValue = false;
+    this->sampleTimer = micros();
+
+    pinMode(pin, INPUT);
+
+    resetCalibration();
+}
+
+/*########################-Set Functions-##########################*/
+
+void MHZ19Analog::setLine(long slope, long offset)
+{
+    this->slope = slope;
+    this->offset = offset;
+}
+
+void MHZ19Analog::resetCalibration()
+{
+    this->pairs = 0;
+    this->n = this->sumX = this->sumY = this->sumXX = this->sumXY = 0;
+
+    /* default line is for a 10 bit value, scale to the decimated resolution */
+    setLine(MHZ19_ANALOG_DEF_SLOPE >> this->bits, MHZ19_ANALOG_DEF_OFFSET);
+}
+
+/*########################-Get Functions-##########################*/
+
+int MHZ19Analog::getCO2()
+{
+    if (!this->hasValue)
+        return 0;
+
+    long ppm = ((this->slope * (long)this->decimated) >> 16) + this->offset;
+
+    if (ppm < 0)
+        ppm = 0;
+    else if (ppm > 32767)
+        ppm = 32767;
+
+    return (int)ppm;
+}
+
+/*######################-Utility Functions-########################*/
+
+bool MHZ19Analog::update()
+{
+    if (micros() - this->sampleTimer < this->interval)
+        return false;
+
+    this->sampleTimer += this->interval;
+
+    /* fell behind (e.g. a long blocking call), don't try to catch up in a burst */
+    if (micros() - this->sampleTimer >= this->interval)
+        this->sampleTimer = micros();
+
+    this->accumulator += analogRead(this->pin);
+
+    /* 4^bits samples give bits extra resolution */
+    if (++this->samples < (1U << (2 * this->bits)))
+        return false;
+
+    this->decimated = (unsigned int)(this->accumulator >> this->bits);
+    this->accumulator = 0;
+    this->samples = 0;
+    this->hasValue = true;
+
+    return true;
+}
+
+void MHZ19Analog::calibrate(int ppm)
+{
+    if (!this->hasValue)
+        return;
+
+    long long x = this->decimated;
+    long long y = ppm;
+
+    /* weight down older pairs, so the fit can follow drift */
+    if (this->n >= 2 * MHZ19_ANALOG_WINDOW)
+    {
+        this->n /= 2;
+        this->sumX /= 2;
+        this->sumY /= 2;
+        this->sumXX /= 2;
+        this->sumXY /= 2;
+    }
+
+    this->n++;
+    this->sumX += x;
+    this->sumY += y;
+    this->sumXX += x * x;
+    this->sumXY += x * y;
+
+    if (this->pairs < 65535)
+        this->pairs++;
+
+    if (isCalibrated())
+        fit();
+}
+
+bool MHZ19Analog::calibrate(MHZ19 &sensor)
+{
+    int ppm = sensor.getCO2();
+
+    if (sensor.errorCode != RESULT_OK || ppm <= 0)
+        return false;
+
+    calibrate(ppm);
+
+    return true;
+}
+
+/*######################-Internal Functions-########################*/
+
+void MHZ19Analog::fit()
+{
+    long long den = this->n * this->sumXX - this->sumX * this->sumX;
+
+    /* all pairs at the same ADC value, keep the current line */
+    if (den <= 0)
+        return;
+
+    long long num = this->n * this->sumXY - this->sumX * this->sumY;
+
+    long long fitSlope = num * 65536 / den;
+    long long fitOffset = (this->sumY * 65536 - fitSlope * this->sumX) / this->n / 65536;
+
+    setLine((long)fitSlope, (long)fitOffset);
+}
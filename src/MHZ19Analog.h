@@ -0,0 +1,93 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#ifndef MHZ19_ANALOG_H
+#define MHZ19_ANALOG_H
+
+#include <Arduino.h>
+#include "MHZ19.h"
+
+#define MHZ19_ANALOG_MAX_BITS 4			// Maximum oversampling bits (4^bits samples per value)
+#define MHZ19_ANALOG_WINDOW 64			// Calibration pairs after which older pairs are weighted down
+#define MHZ19_ANALOG_MIN_PAIRS 4		// Pairs needed before the fitted line is used
+#define MHZ19_ANALOG_DEF_SLOPE 425951L	// Default line, ppm per 10 bit ADC count (Q16, 6.4995)
+#define MHZ19_ANALOG_DEF_OFFSET -591L	// Default line, ppm at ADC count 0
+
+/* Oversampled reader for the sensor's analog output. Each decimated value
+ * gains one bit of resolution per oversampling bit. While UART readings are
+ * available, calibrate() fits the ADC to ppm line by online least squares,
+ * after which the analog path can be used on its own.
+ */
+class MHZ19Analog
+{
+  public:
+	/*#####################-Initiation Functions-#####################*/
+
+	/* pin with the analog output, extra bits of resolution (0 - 4), time between ADC samples (us) */
+	void begin(byte pin, byte oversampleBits = 2, unsigned long sampleInterval = 1000);
+
+	/*########################-Set Functions-##########################*/
+
+	/* sets the ADC to ppm line (slope is Q16 ppm per decimated count), e.g. from a stored fit */
+	void setLine(long slope, long offset);
+
+	/* discards calibration pairs and returns to the default line */
+	void resetCalibration();
+
+	/*########################-Get Functions-##########################*/
+
+	/* latest decimated ADC value, with 10 + oversampleBits bits on a 10 bit ADC */
+	unsigned int getADC() { return this->decimated; };
+
+	/* ppm of the latest decimated value, using the fitted (or default) line */
+	int getCO2();
+
+	/* returns true once enough calibration pairs were fitted */
+	bool isCalibrated() { return this->pairs >= MHZ19_ANALOG_MIN_PAIRS; };
+
+	/* returns the line in use, slope as Q16 ppm per decimated count */
+	long getSlope() { return this->slope; };
+	long getOffset() { return this->offset; };
+
+	/*######################-Utility Functions-########################*/
+
+	/* takes a sample if due, returns true when a new decimated value is ready (never blocks) */
+	bool update();
+
+	/* adds a pair of the latest decimated value against a known ppm and refits */
+	void calibrate(int ppm);
+
+	/* requests CO2 over UART and, if successful, calibrates against it. Returns true if used */
+	bool calibrate(MHZ19 &sensor);
+
+  private:
+	/*###########################-Variables-##########################*/
+
+	byte pin = 0;
+	byte bits = 2;
+	unsigned long interval = 1000;
+	unsigned long sampleTimer = 0;
+
+	/* decimation */
+	unsigned long accumulator = 0;
+	unsigned int samples = 0;
+	unsigned int decimated = 0;
+	bool hasValue = false;
+
+	/* line in use */
+	long slope = MHZ19_ANALOG_DEF_SLOPE;
+	long offset = MHZ19_ANALOG_DEF_OFFSET;
+
+	/* least squares sums, halved as the window fills so the fit follows drift */
+	unsigned int pairs = 0;
+	long long n = 0;
+	long long sumX = 0;
+	long long sumY = 0;
+	long long sumXX = 0;
+	long long sumXY = 0;
+
+	/*######################-Internal Functions-########################*/
+
+	/* recalculates slope and offset from the sums */
+	void fit();
+};
+#endif
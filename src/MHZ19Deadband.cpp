@@ -0,0 +1,109 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#include "MHZ19Deadband.h"
+
+/*########################-Set Functions-##########################*/
+
+void MHZ19Deadband::setDeadband(byte field, long absolute, byte percent)
+{
+    if (field >= DEADBAND_FIELDS)
+        return;
+
+    this->fields[field].absolute = absolute < 0 ? 0 : absolute;
+    this->fields[field].percent = percent;
+}
+
+/*######################-Utility Functions-########################*/
+
+bool MHZ19Deadband::check(byte field, long value)
+{
+    return check(field, value, this->clock ? this->clock() : millis());
+}
+
+byte MHZ19Deadband::update(int ppm, int centi, unsigned int raw)
+{
+    byte publish = 0;
+
+    if (check(DEADBAND_CO2, ppm))
+        publish |= MHZ19_DEADBAND_BIT(DEADBAND_CO2);
+
+    if (check(DEADBAND_TEMPERATURE, centi))
+        publish |= MHZ19_DEADBAND_BIT(DEADBAND_TEMPERATURE);
+
+    if (check(DEADBAND_RAW, raw))
+        publish |= MHZ19_DEADBAND_BIT(DEADBAND_RAW);
+
+    return publish;
+}
+
+byte MHZ19Deadband::update(MHZ19 &sensor, bool isRaw)
+{
+    if (sensor.errorCode != RESULT_OK)
+        return 0;
+
+    /* the filter (setFilter()) checks the last replies as well, and may reject them */
+    int ppm = sensor.getCO2(true, false);
+
+    if (sensor.errorCode != RESULT_OK)
+        return 0;
+
+    unsigned long now = sensor.getClock();
+    byte publish = 0;
+
+    if (check(DEADBAND_CO2, ppm, now))
+        publish |= MHZ19_DEADBAND_BIT(DEADBAND_CO2);
+
+    if (check(DEADBAND_TEMPERATURE, sensor.getTemperatureCenti(false), now))
+        publish |= MHZ19_DEADBAND_BIT(DEADBAND_TEMPERATURE);
+
+    if (isRaw && check(DEADBAND_RAW, sensor.getCO2Raw(false), now))
+        publish |= MHZ19_DEADBAND_BIT(DEADBAND_RAW);
+
+    return publish;
+}
+
+void MHZ19Deadband::reset()
+{
+    for (byte i = 0; i < DEADBAND_FIELDS; i++)
+        this->fields[i].isPublished = false;
+
+    this->checked = 0;
+    this->publishedCount = 0;
+}
+
+/*######################-Internal Functions-########################*/
+
+bool MHZ19Deadband::check(byte field, long value, unsigned long now)
+{
+    if (field >= DEADBAND_FIELDS)
+        return false;
+
+    struct field &state = this->fields[field];
+
+    this->checked++;
+
+    if (state.isPublished)
+    {
+        long band = state.absolute;
+        long relative = (state.published < 0 ? -state.published : state.published) * state.percent / 100;
+
+        if (relative > band)
+            band = relative;
+
+        long moved = value - state.published;
+
+        if (moved < 0)
+            moved = -moved;
+
+        if (moved <= band && (!this->heartbeat || now - state.timer < this->heartbeat))
+            return false;
+    }
+
+    state.published = value;
+    state.timer = now;
+    state.isPublished = true;
+
+    this->publishedCount++;
+
+    return true;
+}
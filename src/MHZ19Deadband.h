@@ -0,0 +1,93 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#ifndef MHZ19_DEADBAND_H
+#define MHZ19_DEADBAND_H
+
+#include <Arduino.h>
+#include "MHZ19.h"
+
+#define MHZ19_DEADBAND_HEARTBEAT 300000UL	// Default longest time without publishing a field (ms)
+#define MHZ19_DEADBAND_BIT(field) (1 << (field))
+
+/* enum alias for fields, see check() */
+enum DEADBANDFIELD
+{
+	DEADBAND_CO2 = 0,					// ppm
+	DEADBAND_TEMPERATURE = 1,			// centi-degrees C, as getTemperatureCenti()
+	DEADBAND_RAW = 2,					// raw value, as getCO2Raw()
+	DEADBAND_FIELDS = 3
+};
+
+/* Report by exception: a field is published only when it moves beyond its
+ * deadband from the value last published, or when the heartbeat expires so
+ * consumers know the node is alive. Each field keeps its own state, so an
+ * uplink sends only the fields which changed.
+ */
+class MHZ19Deadband
+{
+  public:
+	/*########################-Set Functions-##########################*/
+
+	/* a field is published on moving further than the larger of absolute and percent of the value last published */
+	void setDeadband(byte field, long absolute, byte percent = 0);
+
+	/* longest time a field goes unpublished (ms), 0 disables */
+	void setHeartbeat(unsigned long period) { this->heartbeat = period; };
+
+	/* replaces millis() as the heartbeat's time source for check(), as MHZ19::setClock().
+	 * update(MHZ19 &) always uses the sensor's clock
+	 */
+	void setClock(MHZ19Clock clock) { this->clock = clock; };
+
+	/*########################-Get Functions-##########################*/
+
+	/* value of a field last published */
+	long getPublished(byte field) { return field < DEADBAND_FIELDS ? this->fields[field].published : 0; };
+
+	/* values checked and values published, across fields */
+	unsigned long getChecked() { return this->checked; };
+	unsigned long getPublishedCount() { return this->publishedCount; };
+
+	/*######################-Utility Functions-########################*/
+
+	/* returns true when the value should be published, and records it as published */
+	bool check(byte field, long value);
+
+	/* checks a reading, returns a MHZ19_DEADBAND_BIT() per field to publish */
+	byte update(int ppm, int centi, unsigned int raw);
+
+	/* checks the last valid reply from the sensor (CO2 unlimited and temperature, raw with isRaw),
+	 * without communicating. Returns 0 when the last request failed, or the filter rejects the reply
+	 */
+	byte update(MHZ19 &sensor, bool isRaw = false);
+
+	/* the next value of each field is published */
+	void reset();
+
+  private:
+	/*###########################-Variables-##########################*/
+
+	struct field
+	{
+		long absolute;
+		byte percent;
+		long published;
+		unsigned long timer;				// clock time when last published
+		bool isPublished;					// a value has been published since reset()
+	} fields[DEADBAND_FIELDS] = {
+		{ 20, 0, 0, 0, false },				// CO2, 20ppm (within the sensor's accuracy)
+		{ 50, 0, 0, 0, false },				// temperature, 0.5C
+		{ 100, 0, 0, 0, false }				// raw
+	};
+
+	unsigned long heartbeat = MHZ19_DEADBAND_HEARTBEAT;
+	MHZ19Clock clock = NULL;
+	unsigned long checked = 0;
+	unsigned long publishedCount = 0;
+
+	/*######################-Internal Functions-########################*/
+
+	/* check() at clock time now */
+	bool check(byte field, long value, unsigned long now);
+};
+#endif
@@ -0,0 +1,262 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#include "MHZ19Export.h"
+
+/* Print sink over a fixed buffer, rolls back to the last whole line when full */
+class MHZ19LineBuffer : public Print
+{
+  public:
+    MHZ19LineBuffer(char *buffer, size_t size) : buffer(buffer), size(size) {}
+
+    size_t write(uint8_t c)
+    {
+        if (this->full)
+            return 0;
+
+        /* room is kept for the terminator */
+        if (this->length + 1 >= this->size)
+        {
+            this->full = true;
+            this->length = this->lineEnd;
+            return 0;
+        }
+
+        this->buffer[this->length++] = c;
+
+        if (c == '\n')
+            this->lineEnd = this->length;
+
+        return 1;
+    }
+
+    size_t finish()
+    {
+        if (this->size)
+            this->buffer[this->length] = '\0';
+
+        return this->length;
+    }
+
+  private:
+    char *buffer;
+    size_t size;
+    size_t length = 0;
+    size_t lineEnd = 0;
+    bool full = false;
+};
+
+/* Prometheus label / Influx field name for each ERRORCODE value */
+static const __FlashStringHelper *resultName(byte result)
+{
+    switch (result)
+    {
+    case RESULT_OK:
+        return F("ok");
+    case RESULT_TIMEOUT:
+        return F("timeout");
+    case RESULT_MATCH:
+        return F("match");
+    case RESULT_CRC:
+        return F("crc");
+    case RESULT_FILTER:
+        return F("filter");
+    default:
+        return F("null");
+    }
+}
+
+/*#####################-Initiation Functions-#####################*/
+
+void MHZ19Export::begin(MHZ19 &sensor, byte format, const char *name)
+{
+    this->sensor = &sensor;
+    this->format = format;
+
+    if (!name || !*name)
+        name = "mhz19";
+
+    /* anything else would break out of a label's quotes or an Influx tag, so it becomes '_' */
+    byte i = 0;
+
+    for (; i < MHZ19_EXPORT_NAME && name[i]; i++)
+    {
+        char c = name[i];
+        bool isAllowed = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+
+        this->name[i] = isAllowed ? c : '_';
+    }
+
+    this->name[i] = '\0';
+}
+
+/*######################-Utility Functions-########################*/
+
+size_t MHZ19Export::write(Print &out, bool force)
+{
+    if (!this->sensor)
+        return 0;
+
+    /* CO2 first, its reply carries temperature too, except on older firmware (limited CO2, 134) */
+    int CO2 = this->sensor->getCO2(true, force);
+    bool isValid = this->sensor->errorCode == RESULT_OK;
+
+    int centi = this->sensor->getTemperatureCenti(force && !this->sensor->isTemperatureWithCO2());
+    isValid = isValid && this->sensor->errorCode == RESULT_OK;
+
+    /* count through a wrapper so the total is known whatever out returns */
+    class Counter : public Print
+    {
+      public:
+        Counter(Print &out) : out(out) {}
+        size_t write(uint8_t c) { size_t n = this->out.write(c); this->count += n; return n; }
+        Print &out;
+        size_t count = 0;
+    } counter(out);
+
+    if (this->format == EXPORT_INFLUX)
+        writeInflux(counter, CO2, centi, isValid);
+    else
+        writePrometheus(counter, CO2, centi, isValid);
+
+    return counter.count;
+}
+
+size_t MHZ19Export::write(char *buffer, size_t size, bool force)
+{
+    MHZ19LineBuffer sink(buffer, size);
+
+    write(sink, force);
+
+    return sink.finish();
+}
+
+/*######################-Internal Functions-########################*/
+
+void MHZ19Export::writePrometheus(Print &out, int CO2, int centi, bool isValid)
+{
+    /* readings are left out rather than exported as 0 when the request failed */
+    if (isValid)
+    {
+        type(out, F("co2_ppm"), F("gauge"));
+        sample(out, F("co2_ppm"), NULL, CO2);
+
+        type(out, F("temperature_celsius"), F("gauge"));
+        out.print(F("mhz19_temperature_celsius{sensor=\""));
+        out.print(this->name);
+        out.print(F("\"} "));
+        printCenti(out, centi);
+        out.print('\n');
+    }
+
+    type(out, F("error_code"), F("gauge"));
+    sample(out, F("error_code"), NULL, this->sensor->errorCode);
+
+    /* counts are left out when compiled out, rather than exported as 0 */
+#if MHZ19_ERRORS
+    type(out, F("replies_total"), F("counter"));
+    for (byte result = RESULT_OK; result <= RESULT_FILTER; result++)
+        sample(out, F("replies_total"), resultName(result), this->sensor->getResultCount(result));
+
+    byte history[MHZ19_HISTORY_DEPTH];
+    byte held = this->sensor->getHistory(history, MHZ19_HISTORY_DEPTH);
+    long failures = 0;
+
+    for (byte i = 0; i < held; i++)
+    {
+        if (history[i] != RESULT_OK)
+            failures++;
+    }
+
+    type(out, F("recent_failures"), F("gauge"));
+    sample(out, F("recent_failures"), NULL, failures);
+#endif
+}
+
+void MHZ19Export::writeInflux(Print &out, int CO2, int centi, bool isValid)
+{
+    out.print(F("mhz19,sensor="));
+    out.print(this->name);
+
+    out.print(F(" error_code="));
+    out.print(this->sensor->errorCode);
+    out.print('i');
+
+#if MHZ19_ERRORS
+    for (byte result = RESULT_OK; result <= RESULT_FILTER; result++)
+    {
+        out.print(',');
+        out.print(resultName(result));
+        out.print('=');
+        out.print(this->sensor->getResultCount(result));
+        out.print('i');
+    }
+
+    /* history as a string of errorCode digits, newest first */
+    byte history[MHZ19_HISTORY_DEPTH];
+    byte held = this->sensor->getHistory(history, MHZ19_HISTORY_DEPTH);
+
+    out.print(F(",history=\""));
+    for (byte i = 0; i < held; i++)
+        out.print((char)('0' + history[i]));
+    out.print('"');
+#endif
+
+    if (isValid)
+    {
+        out.print(F(",co2="));
+        out.print(CO2);
+        out.print(F("i,temperature="));
+        printCenti(out, centi);
+    }
+
+    out.print('\n');
+}
+
+void MHZ19Export::sample(Print &out, const __FlashStringHelper *metric, const __FlashStringHelper *label, long value)
+{
+    out.print(F("mhz19_"));
+    out.print(metric);
+    out.print(F("{sensor=\""));
+    out.print(this->name);
+
+    if (label)
+    {
+        out.print(F("\",result=\""));
+        out.print(label);
+    }
+
+    out.print(F("\"} "));
+    out.print(value);
+    out.print('\n');
+}
+
+void MHZ19Export::type(Print &out, const __FlashStringHelper *metric, const __FlashStringHelper *kind)
+{
+    if (!this->types)
+        return;
+
+    out.print(F("# TYPE mhz19_"));
+    out.print(metric);
+    out.print(' ');
+    out.print(kind);
+    out.print('\n');
+}
+
+void MHZ19Export::printCenti(Print &out, int centi)
+{
+    long value = centi;
+
+    if (value < 0)
+    {
+        out.print('-');
+        value = -value;
+    }
+
+    out.print(value / 100);
+    out.print('.');
+
+    if (value % 100 < 10)
+        out.print('0');
+
+    out.print(value % 100);
+}
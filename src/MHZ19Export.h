@@ -0,0 +1,72 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#ifndef MHZ19_EXPORT_H
+#define MHZ19_EXPORT_H
+
+#include <Arduino.h>
+#include "MHZ19.h"
+
+#define MHZ19_EXPORT_NAME 24			// Longest sensor name used as label / tag (characters)
+
+/* enum alias for export formats */
+enum EXPORTFORMAT
+{
+	EXPORT_PROMETHEUS = 0,				// Prometheus text exposition
+	EXPORT_INFLUX = 1					// Influx line protocol
+};
+
+/* Writes readings, result counts and recent errorCode history of a sensor as
+ * monitoring text, straight to a Print sink or a caller's buffer. Numbers are
+ * printed as they go, so nothing is allocated and no String is built.
+ * Output is at most about 850 characters (Prometheus) or 250 (Influx) with the
+ * longest name and full counters. Counts and history are left out when
+ * MHZ19_ERRORS is 0.
+ */
+class MHZ19Export
+{
+  public:
+	/*#####################-Initiation Functions-#####################*/
+
+	/* name becomes the sensor label / tag, letters, digits and '_' only. Other characters are
+	 * replaced by '_', and longer names are cut
+	 */
+	void begin(MHZ19 &sensor, byte format = EXPORT_PROMETHEUS, const char *name = "mhz19");
+
+	/*########################-Set Functions-##########################*/
+
+	/* Prometheus only, OFF leaves out "# TYPE" lines when several sensors share one page (keep ON for the first) */
+	void setTypes(bool isON = true) { this->types = isON; };
+
+	/*######################-Utility Functions-########################*/
+
+	/* writes to out, force requests fresh readings first, returns characters written */
+	size_t write(Print &out, bool force = true);
+
+	/* writes into buffer (terminated), only whole lines are kept when it is too small.
+	 * Returns the length written, excluding the terminator
+	 */
+	size_t write(char *buffer, size_t size, bool force = true);
+
+  private:
+	/*###########################-Variables-##########################*/
+
+	MHZ19 *sensor = NULL;
+	byte format = EXPORT_PROMETHEUS;
+	bool types = true;
+	char name[MHZ19_EXPORT_NAME + 1] = "mhz19";
+
+	/*######################-Internal Functions-########################*/
+
+	void writePrometheus(Print &out, int CO2, int centi, bool isValid);
+	void writeInflux(Print &out, int CO2, int centi, bool isValid);
+
+	/* one Prometheus sample line, label is an extra "key=\"value\"" pair or NULL */
+	void sample(Print &out, const __FlashStringHelper *metric, const __FlashStringHelper *label, long value);
+
+	/* "# TYPE" line */
+	void type(Print &out, const __FlashStringHelper *metric, const __FlashStringHelper *kind);
+
+	/* hundredths as a decimal, without floats */
+	void printCenti(Print &out, int centi);
+};
+#endif
@@ -0,0 +1,134 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#include "MHZ19Fusion.h"
+
+/*#####################-Initiation Functions-#####################*/
+
+int8_t MHZ19Fusion::add(MHZ19 &sensor)
+{
+    if (this->count >= MHZ19_FUSION_MAX)
+        return -1;
+
+    this->sensors[this->count] = &sensor;
+    this->readings[this->count] = 0;
+
+    return this->count++;
+}
+
+/*########################-Set Functions-##########################*/
+
+void MHZ19Fusion::setThreshold(int ppm, byte percent)
+{
+    /* at least 1ppm, the agreement score divides by it */
+    this->thresholdPPM = ppm < 1 ? 1 : ppm;
+    this->thresholdPercent = percent;
+}
+
+/*######################-Utility Functions-########################*/
+
+int MHZ19Fusion::update()
+{
+    int ppm[MHZ19_FUSION_MAX];
+    byte codes[MHZ19_FUSION_MAX];
+
+    for (byte i = 0; i < this->count; i++)
+    {
+        ppm[i] = this->sensors[i]->getCO2();
+        codes[i] = this->sensors[i]->errorCode;
+    }
+
+    return fuse(ppm, codes, this->count);
+}
+
+int MHZ19Fusion::fuse(const int ppm[], const byte codes[], byte count)
+{
+    int sorted[MHZ19_FUSION_MAX];
+    byte valid = 0;
+
+    if (count > MHZ19_FUSION_MAX)
+        count = MHZ19_FUSION_MAX;
+
+    this->excluded = 0;
+
+    /* insertion sort of usable readings, O(n^2) but n is at most MHZ19_FUSION_MAX */
+    for (byte i = 0; i < count; i++)
+    {
+        this->readings[i] = ppm[i];
+
+        if (codes[i] != RESULT_OK || ppm[i] <= 0)
+        {
+            this->excluded |= (1 << i);
+            continue;
+        }
+
+        byte j = valid++;
+
+        while (j > 0 && sorted[j - 1] > ppm[i])
+        {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = ppm[i];
+    }
+
+    this->used = 0;
+    this->fused = 0;
+    this->confidence = 0;
+
+    if (!valid)
+        return 0;
+
+    long median = (valid & 1) ? sorted[valid / 2] : ((long)sorted[valid / 2 - 1] + sorted[valid / 2]) / 2;
+
+    long threshold = median * this->thresholdPercent / 100;
+    if (threshold < this->thresholdPPM)
+        threshold = this->thresholdPPM;
+
+    /* exclude outliers, average the rest */
+    long sum = 0;
+    long deviation = 0;
+
+    for (byte i = 0; i < count; i++)
+    {
+        if (this->excluded & (1 << i))
+            continue;
+
+        long distance = ppm[i] - median;
+        if (distance < 0)
+            distance = -distance;
+
+        if (distance > threshold)
+        {
+            this->excluded |= (1 << i);
+            continue;
+        }
+
+        sum += ppm[i];
+        deviation += distance;
+        this->used++;
+    }
+
+    /* two clusters either side of the median exclude everything, so give the median with no confidence */
+    if (!this->used)
+    {
+        this->fused = (int)median;
+        return this->fused;
+    }
+
+    this->fused = (int)((sum + this->used / 2) / this->used);
+
+    /* share used, scaled down as the spread nears the threshold */
+    long agreement = 100 - (100 * deviation / this->used) / threshold;
+    if (agreement < 0)
+        agreement = 0;
+
+    long score = (long)this->used * 100 / count * agreement / 100;
+
+    /* a lone sensor cannot be cross-checked */
+    if (this->used < 2 && score > 50)
+        score = 50;
+
+    this->confidence = (byte)score;
+
+    return this->fused;
+}
@@ -0,0 +1,71 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#ifndef MHZ19_FUSION_H
+#define MHZ19_FUSION_H
+
+#include <Arduino.h>
+#include "MHZ19.h"
+
+#define MHZ19_FUSION_MAX 8				// Sensors which can be fused (fixed, no heap)
+
+/* Fuses readings from redundant sensors in the same space. Each cycle,
+ * sensors with a failed request or too far from the median are excluded,
+ * the rest are averaged, and a 0 - 100 confidence is given. Readings are
+ * sorted by insertion, O(n^2) in the sensors but bounded by MHZ19_FUSION_MAX.
+ */
+class MHZ19Fusion
+{
+  public:
+	/*#####################-Initiation Functions-#####################*/
+
+	/* adds a sensor, returns its index or -1 when full */
+	int8_t add(MHZ19 &sensor);
+
+	/*########################-Set Functions-##########################*/
+
+	/* a reading is an outlier when further from the median than the larger of ppm (at least 1) and percent of the median */
+	void setThreshold(int ppm = 100, byte percent = 10);
+
+	/*########################-Get Functions-##########################*/
+
+	/* fused ppm of the last cycle, 0 if no sensor was usable. When every reading was an outlier
+	 * (e.g. two sensors far apart), the median with confidence 0
+	 */
+	int getCO2() { return this->fused; };
+
+	/* 0 - 100, share of sensors used scaled by how closely they agree (at most 50 from one sensor) */
+	byte getConfidence() { return this->confidence; };
+
+	/* sensors used in the last cycle */
+	byte getUsed() { return this->used; };
+
+	/* bit per sensor index excluded in the last cycle */
+	byte getExcluded() { return this->excluded; };
+
+	/* reading of one sensor in the last cycle */
+	int getReading(byte index) { return index < this->count ? this->readings[index] : 0; };
+
+	/*######################-Utility Functions-########################*/
+
+	/* requests CO2 from every sensor and fuses the readings, returns the fused ppm */
+	int update();
+
+	/* fuses readings gathered elsewhere, codes are the matching ERRORCODE values */
+	int fuse(const int ppm[], const byte codes[], byte count);
+
+  private:
+	/*###########################-Variables-##########################*/
+
+	MHZ19 *sensors[MHZ19_FUSION_MAX];
+	byte count = 0;
+
+	int thresholdPPM = 100;
+	byte thresholdPercent = 10;
+
+	int readings[MHZ19_FUSION_MAX];
+	int fused = 0;
+	byte confidence = 0;
+	byte used = 0;
+	byte excluded = 0;
+};
+#endif
@@ -0,0 +1,189 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#include "MHZ19.h"
+
+/* the library is compiled whole, so only sketches including MHZ19Mux.h stop without async */
+#if MHZ19_ENABLE_ASYNC
+#include "MHZ19Mux.h"
+
+/*#####################-Initiation Functions-#####################*/
+
+void MHZ19Mux::begin(Stream &serial, const byte selectPins[], byte selectCount, byte enablePin)
+{
+    this->serial = &serial;
+    this->pinCount = selectCount > 4 ? 4 : selectCount;
+    this->enablePin = enablePin;
+
+    for (byte i = 0; i < this->pinCount; i++)
+    {
+        this->pins[i] = selectPins[i];
+        pinMode(this->pins[i], OUTPUT);
+    }
+
+    if (this->enablePin != MHZ19_MUX_NONE)
+    {
+        pinMode(this->enablePin, OUTPUT);
+        digitalWrite(this->enablePin, LOW);
+    }
+
+    memset(this->sensors, 0, sizeof(this->sensors));
+    this->clockSource = NULL;
+
+    this->state = MUX_NEXT;
+    this->channel = MHZ19_MUX_CHANNELS - 1;
+    this->sweeps = 0;
+    this->failures = 0;
+    this->sweepTime = 0;
+    this->sweepPeriod = 0;
+    this->isSweeping = false;
+
+    setChannel(0);
+}
+
+int MHZ19Mux::add(MHZ19 &sensor, byte channel)
+{
+    if (channel >= MHZ19_MUX_CHANNELS || channel >= (1 << this->pinCount))
+        return -1;
+
+    this->sensors[channel] = &sensor;
+
+    if (!this->clockSource)
+        this->clockSource = &sensor;
+
+    select(channel);
+
+    int result = sensor.begin(*this->serial);
+    sensor.autoMaintenance(false);
+
+    return result;
+}
+
+/*######################-Utility Functions-########################*/
+
+int8_t MHZ19Mux::update()
+{
+    switch (this->state)
+    {
+    case MUX_NEXT:
+    {
+        byte next = nextChannel(this->channel);
+
+        if (next == MHZ19_MUX_CHANNELS)
+            return -1;
+
+        /* wrapping round starts a new sweep */
+        if (next <= this->channel || !this->isSweeping)
+        {
+            if (this->isSweeping && this->interval && clockNow() - this->sweepStart < this->interval)
+                return -1;
+
+            if (this->isSweeping)
+                this->sweepPeriod = clockNow() - this->sweepStart;
+
+            this->sweepStart = clockNow();
+            this->isSweeping = true;
+        }
+
+        setChannel(next);
+        this->state = MUX_SETTLE;
+    }
+    /* fall through */
+    case MUX_SETTLE:
+        if (micros() - this->switchTime < this->settle)
+            return -1;
+
+        flush();
+
+        /* the sensor's own maintenance is off, so any jobs due run while its channel is selected */
+        this->sensors[this->channel]->maintain();
+
+        if (!this->sensors[this->channel]->requestCO2())
+        {
+            this->failures++;
+            endRequest();
+            return -1;
+        }
+
+        this->state = MUX_WAIT;
+        return -1;
+
+    case MUX_WAIT:
+        if (!this->sensors[this->channel]->receive())
+            return -1;
+
+        endRequest();
+
+        return this->channel;
+    }
+
+    return -1;
+}
+
+bool MHZ19Mux::select(byte channel)
+{
+    if (channel >= MHZ19_MUX_CHANNELS || !this->sensors[channel])
+        return false;
+
+    /* receive() ends by time out at the latest */
+    while (this->sensors[this->channel] && this->sensors[this->channel]->isPending())
+    {
+        if (!this->sensors[this->channel]->receive())
+            yield();
+    }
+
+    setChannel(channel);
+
+    /* delayMicroseconds() is only accurate up to 16383 us, so whole ms are left to delay() */
+    delay(this->settle / 1000);
+    delayMicroseconds(this->settle % 1000);
+
+    flush();
+
+    /* a sweep in progress is restarted from the next channel */
+    this->state = MUX_NEXT;
+
+    return true;
+}
+
+/*######################-Internal Functions-########################*/
+
+void MHZ19Mux::setChannel(byte channel)
+{
+    for (byte i = 0; i < this->pinCount; i++)
+        digitalWrite(this->pins[i], (channel >> i) & 1 ? HIGH : LOW);
+
+    this->channel = channel;
+    this->switchTime = micros();
+}
+
+void MHZ19Mux::endRequest()
+{
+    this->state = MUX_NEXT;
+
+    /* the last sensor before wrapping ends the sweep */
+    if (nextChannel(this->channel) <= this->channel)
+    {
+        this->sweepTime = clockNow() - this->sweepStart;
+        this->sweeps++;
+    }
+}
+
+void MHZ19Mux::flush()
+{
+    while (this->serial->available())
+        this->serial->read();
+}
+
+byte MHZ19Mux::nextChannel(byte channel)
+{
+    for (byte i = 1; i <= MHZ19_MUX_CHANNELS; i++)
+    {
+        byte next = (channel + i) % MHZ19_MUX_CHANNELS;
+
+        if (this->sensors[next])
+            return next;
+    }
+
+    return MHZ19_MUX_CHANNELS;
+}
+#endif
@@ -0,0 +1,131 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#ifndef MHZ19_MUX_H
+#define MHZ19_MUX_H
+
+#include <Arduino.h>
+#include "MHZ19.h"
+
+/* the round robin is built on requestCO2() / receive(), which are stubs without it */
+#if !MHZ19_ENABLE_ASYNC
+#error "MHZ19Mux needs MHZ19_ENABLE_ASYNC 1"
+#endif
+
+#define MHZ19_MUX_CHANNELS 16			// Channels addressable with 4 select pins (74HC4067)
+#define MHZ19_MUX_SETTLE 1000			// Default settle time after switching channel (us)
+#define MHZ19_MUX_NONE 255				// No enable pin
+
+/* Serves several sensors through one serial port and an analog mux (74HC4051 /
+ * 4052 / 4067, TX and RX both switched). update() runs a round robin: select a
+ * channel, wait the settle time, flush stale bytes, run the sensor's due
+ * maintenance, request CO2 and collect the reply, then move to the next
+ * channel. Only the maintenance blocks (see update()). Replies are read
+ * per sensor with getCO2(true, false) / errorCode, or from its onFrame() callback.
+ */
+class MHZ19Mux
+{
+  public:
+	/*#####################-Initiation Functions-#####################*/
+
+	/* select pins are given low bit first (1 - 4 pins), enablePin is the mux's active low inhibit */
+	void begin(Stream &serial, const byte selectPins[], byte selectCount, byte enablePin = MHZ19_MUX_NONE);
+
+	/* selects channel and runs sensor.begin() on it, return is that of begin() (0 on success, -1 bad channel).
+	 * Automatic maintenance is turned OFF for the sensor, as it would talk to whichever channel is selected.
+	 * update() runs its maintain() instead, with the channel selected and before its request
+	 */
+	int add(MHZ19 &sensor, byte channel);
+
+	/*########################-Set Functions-##########################*/
+
+	/* time allowed for the line to settle after switching (us) */
+	void setSettle(unsigned long settle) { this->settle = settle; };
+
+	/* shortest time between the starts of two sweeps (ms), 0 (default) sweeps back to back.
+	 * Sweeps are timed with the clock of the first sensor added (see MHZ19::setClock()),
+	 * sensors sharing a mux are expected to share a clock
+	 */
+	void setInterval(unsigned long interval) { this->interval = interval; };
+
+	/*########################-Get Functions-##########################*/
+
+	/* duration of the last complete sweep over all channels (ms), 0 before the first */
+	unsigned long getSweepTime() { return this->sweepTime; };
+
+	/* sweeps per hour achieved by the last sweep, including any setInterval() wait */
+	unsigned long getSweepRate() { return this->sweepPeriod ? 3600000UL / this->sweepPeriod : 0; };
+
+	/* complete sweeps since begin() */
+	unsigned long getSweeps() { return this->sweeps; };
+
+	/* requests which a channel's sensor refused to send (a reply to another request still awaited) */
+	unsigned long getFailures() { return this->failures; };
+
+	/* channel currently selected */
+	byte getChannel() { return this->channel; };
+
+	/*######################-Utility Functions-########################*/
+
+	/* advances the round robin, returns the channel whose request just finished, or -1.
+	 * Does not wait, except while a sensor's maintenance jobs fall due: those run blocking
+	 * with its channel selected, up to 2 x TIMEOUT_PERIOD for a verify or a readback (see
+	 * MHZ19::setVerifyPeriod()). Keep their periods long on a mux which must not stall
+	 */
+	int8_t update();
+
+	/* finishes any request in flight, then selects channel (settled and flushed) for blocking calls
+	 * on its sensor, e.g. setRange(). update() carries on from the next channel afterwards.
+	 * Returns false for a channel without a sensor
+	 */
+	bool select(byte channel);
+
+  private:
+	/*###########################-Variables-##########################*/
+
+	/* alias for round robin states */
+	typedef enum MUX_STATE
+	{
+		MUX_NEXT = 0,			// 0 Move to the next channel
+		MUX_SETTLE = 1,			// 1 Waiting for the line to settle
+		MUX_WAIT = 2			// 2 Waiting for the reply
+	} Mux_State;
+
+	Stream *serial = NULL;
+	MHZ19 *sensors[MHZ19_MUX_CHANNELS];
+	byte pins[4];
+	byte pinCount = 0;
+	byte enablePin = MHZ19_MUX_NONE;
+
+	unsigned long settle = MHZ19_MUX_SETTLE;
+	unsigned long interval = 0;
+
+	byte state = MUX_NEXT;
+	byte channel = 0;
+	unsigned long switchTime = 0;			// micros() when the channel was switched
+
+	MHZ19 *clockSource = NULL;				// first sensor added, whose clock times sweeps
+	unsigned long sweepStart = 0;			// clock time when the current sweep started
+	unsigned long sweepTime = 0;
+	unsigned long sweepPeriod = 0;			// start to start of the last two sweeps (ms)
+	unsigned long sweeps = 0;
+	unsigned long failures = 0;
+	bool isSweeping = false;
+
+	/*######################-Internal Functions-########################*/
+
+	/* drives the select pins */
+	void setChannel(byte channel);
+
+	/* moves on from the channel's request, finished or not sent, ending the sweep after the last channel */
+	void endRequest();
+
+	/* discards bytes received while switching */
+	void flush();
+
+	/* first channel with a sensor after channel (wrapping), or MHZ19_MUX_CHANNELS if none */
+	byte nextChannel(byte channel);
+
+	/* current time from the first sensor's clock, millis() before one is added */
+	unsigned long clockNow() { return this->clockSource ? this->clockSource->getClock() : millis(); };
+};
+#endif
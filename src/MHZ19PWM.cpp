@@ -0,0 +1,170 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#include "MHZ19PWM.h"
+
+/* interrupt handlers must be placed in RAM on Espressif chips */
+#if defined (ESP32) || defined (ESP8266)
+#define MHZ19_ISR_ATTR IRAM_ATTR
+#else
+#define MHZ19_ISR_ATTR
+#endif
+
+MHZ19PWM *MHZ19PWM::readers[MHZ19_PWM_MAX] = { NULL };
+
+/*#####################-Initiation Functions-#####################*/
+
+int MHZ19PWM::begin(byte pin, int range)
+{
+    static void (*const trampolines[MHZ19_PWM_MAX])() = { isr0, isr1, isr2, isr3 };
+
+    if (digitalPinToInterrupt(pin) == NOT_AN_INTERRUPT)
+        return 1;
+
+    /* release any previous attachment */
+    end();
+
+    for (byte i = 0; i < MHZ19_PWM_MAX; i++)
+    {
+        if (readers[i] == NULL)
+        {
+            this->pin = pin;
+            this->range = range;
+            this->slot = i;
+            this->hasRise = false;
+            this->hasFall = false;
+            this->isFresh = false;
+            this->isInvalid = false;
+            this->cycleTime = 0;
+
+            readers[i] = this;
+
+            pinMode(pin, INPUT);
+            attachInterrupt(digitalPinToInterrupt(pin), trampolines[i], CHANGE);
+
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void MHZ19PWM::end()
+{
+    if (this->slot < 0)
+        return;
+
+    detachInterrupt(digitalPinToInterrupt(this->pin));
+
+    readers[this->slot] = NULL;
+    this->slot = -1;
+}
+
+/*########################-Get Functions-##########################*/
+
+bool MHZ19PWM::available()
+{
+    return this->isFresh;
+}
+
+int MHZ19PWM::getCO2()
+{
+    unsigned long high, cycle;
+
+    /* copy both values from the same cycle */
+    noInterrupts();
+    high = this->highTime;
+    cycle = this->cycleTime;
+    this->isFresh = false;
+    interrupts();
+
+    if (!cycle)
+        return 0;
+
+    /* datasheet: Cppm = range * (TH - 2ms) / (TH + TL - 4ms), in 10us steps to stay within 32 bits */
+    if (high <= 2000)
+        return 0;
+
+    long ppm = (long)this->range * (long)((high - 2000) / 10) / (long)((cycle - 4000) / 10);
+
+    if (ppm > this->range)
+        ppm = this->range;
+
+    return (int)ppm;
+}
+
+unsigned long MHZ19PWM::getAge()
+{
+    unsigned long stamp;
+
+    noInterrupts();
+    stamp = this->validTime;
+    interrupts();
+
+    return millis() - stamp;
+}
+
+byte MHZ19PWM::getStatus()
+{
+    if (this->slot < 0 || !this->cycleTime)
+        return PWM_NONE;
+
+    if (this->isInvalid)
+        return PWM_INVALID;
+
+    if (getAge() >= MHZ19_PWM_STALE)
+        return PWM_STALE;
+
+    return PWM_OK;
+}
+
+/*######################-Utility Functions-########################*/
+
+MHZ19_ISR_ATTR void MHZ19PWM::handleEdge(bool level, unsigned long timeStamp)
+{
+    if (!level)
+    {
+        /* high time ends */
+        if (this->hasRise)
+        {
+            this->fallTime = timeStamp;
+            this->hasFall = true;
+        }
+        return;
+    }
+
+    /* a rising edge completes the cycle started by the previous one */
+    if (this->hasRise && this->hasFall)
+    {
+        unsigned long cycle = timeStamp - this->riseTime;
+        unsigned long high = this->fallTime - this->riseTime;
+
+        const unsigned long nominal = MHZ19_PWM_CYCLE * 1000UL;
+        const unsigned long tolerance = nominal / 100 * MHZ19_PWM_TOLERANCE;
+
+        if (cycle >= nominal - tolerance && cycle <= nominal + tolerance && high < cycle)
+        {
+            this->highTime = high;
+            this->cycleTime = cycle;
+            this->validTime = millis();
+            this->isFresh = true;
+            this->isInvalid = false;
+        }
+        else
+            this->isInvalid = true;
+    }
+
+    this->riseTime = timeStamp;
+    this->hasRise = true;
+    this->hasFall = false;
+}
+
+/*######################-Internal Functions-########################*/
+
+MHZ19_ISR_ATTR void MHZ19PWM::onInterrupt()
+{
+    handleEdge(digitalRead(this->pin) == HIGH, micros());
+}
+
+MHZ19_ISR_ATTR void MHZ19PWM::isr0() { if (readers[0]) readers[0]->onInterrupt(); }
+MHZ19_ISR_ATTR void MHZ19PWM::isr1() { if (readers[1]) readers[1]->onInterrupt(); }
+MHZ19_ISR_ATTR void MHZ19PWM::isr2() { if (readers[2]) readers[2]->onInterrupt(); }
+MHZ19_ISR_ATTR void MHZ19PWM::isr3() { if (readers[3]) readers[3]->onInterrupt(); }
@@ -0,0 +1,93 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#ifndef MHZ19_PWM_H
+#define MHZ19_PWM_H
+
+#include <Arduino.h>
+#include "MHZ19.h"
+
+#define MHZ19_PWM_MAX 4				// Readers which can be attached to interrupts at once (one isr each)
+#define MHZ19_PWM_CYCLE 1004		// Nominal PWM cycle (ms)
+#define MHZ19_PWM_TOLERANCE 5		// Accepted deviation from the nominal cycle (%)
+#define MHZ19_PWM_STALE 3000		// Age after which a reading is reported stale (ms)
+
+/* enum alias for PWM reader status, see getStatus() */
+enum PWMSTATUS
+{
+	PWM_NONE = 0,				// Not attached, or no complete cycle yet
+	PWM_OK = 1,					// Latest cycle decoded and fresh
+	PWM_STALE = 2,				// No valid cycle within MHZ19_PWM_STALE
+	PWM_INVALID = 3				// Latest cycle was outside the nominal period
+};
+
+/* Decodes CO2 from the sensor's PWM pin, without UART traffic. Edges are
+ * timestamped from an interrupt, the ppm is only calculated when read.
+ */
+class MHZ19PWM
+{
+  public:
+	/*#####################-Initiation Functions-#####################*/
+
+	/* attaches to an interrupt capable pin, range must match the sensor's (see getRange())
+	 * return 0 on success, non-zero if no reader slot or interrupt is available
+	 */
+	int begin(byte pin, int range = DEFAULT_RANGE);
+
+	/* detaches from the interrupt */
+	void end();
+
+	/*########################-Set Functions-##########################*/
+
+	/* sets range used in the ppm calculation, if changed with setRange() */
+	void setRange(int range) { this->range = range; };
+
+	/*########################-Get Functions-##########################*/
+
+	/* returns true if a cycle completed since the last getCO2() */
+	bool available();
+
+	/* returns ppm from the latest valid cycle, 0 if none (never blocks) */
+	int getCO2();
+
+	/* returns ms since the latest valid cycle completed */
+	unsigned long getAge();
+
+	/* returns PWMSTATUS of the reader */
+	byte getStatus();
+
+	/*######################-Utility Functions-########################*/
+
+	/* processes one edge, called from the interrupt (or directly, to feed recorded edges) */
+	void handleEdge(bool level, unsigned long timeStamp);
+
+  private:
+	/*###########################-Variables-##########################*/
+
+	byte pin = 0;
+	int range = DEFAULT_RANGE;
+	int8_t slot = -1;								// interrupt trampoline in use
+
+	/* written by the interrupt */
+	volatile unsigned long riseTime = 0;			// start of the current cycle (us)
+	volatile unsigned long fallTime = 0;			// end of the high time (us)
+	volatile unsigned long highTime = 0;			// high time of the latest valid cycle (us)
+	volatile unsigned long cycleTime = 0;			// period of the latest valid cycle (us)
+	volatile unsigned long validTime = 0;			// millis() when the latest valid cycle ended
+	volatile bool hasRise = false;
+	volatile bool hasFall = false;
+	volatile bool isFresh = false;
+	volatile bool isInvalid = false;
+
+	/*######################-Internal Functions-########################*/
+
+	static MHZ19PWM *readers[MHZ19_PWM_MAX];
+
+	static void isr0();
+	static void isr1();
+	static void isr2();
+	static void isr3();
+
+	/* reads the pin and timestamps the edge */
+	void onInterrupt();
+};
+#endif
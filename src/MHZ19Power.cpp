@@ -0,0 +1,164 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#include "MHZ19Power.h"
+
+/*#####################-Initiation Functions-#####################*/
+
+void MHZ19Power::begin(MHZ19 &sensor, byte pin, bool isActiveHigh)
+{
+    this->sensor = &sensor;
+    this->pin = pin;
+    this->isActiveHigh = isActiveHigh;
+
+    /* maintenance would otherwise reach an unpowered sensor, update() runs it once ready */
+    this->sensor->autoMaintenance(false);
+
+    pinMode(this->pin, OUTPUT);
+    setSupply(false);
+
+    this->state = POWER_OFF;
+}
+
+/*########################-Set Functions-##########################*/
+
+void MHZ19Power::setTiming(unsigned long boot, unsigned long warmup, unsigned long check)
+{
+    this->boot = boot;
+    this->warmup = warmup;
+    this->check = check;
+}
+
+/*########################-Get Functions-##########################*/
+
+unsigned long MHZ19Power::getUptime()
+{
+    return this->state == POWER_OFF ? 0 : this->sensor->getClock() - this->onTimer;
+}
+
+unsigned long MHZ19Power::getOnTime()
+{
+    return this->onTotal + getUptime();
+}
+
+unsigned long MHZ19Power::getOnTimePerSample()
+{
+    return this->samples ? getOnTime() / this->samples : 0;
+}
+
+/*######################-Utility Functions-########################*/
+
+void MHZ19Power::on()
+{
+    if (this->state != POWER_OFF)
+        return;
+
+    setSupply(true);
+
+    this->onTimer = this->sensor->getClock();
+    this->warmupTime = 0;
+    this->state = POWER_BOOT;
+}
+
+void MHZ19Power::off()
+{
+    if (this->state == POWER_OFF)
+        return;
+
+    this->onTotal += this->sensor->getClock() - this->onTimer;
+
+    setSupply(false);
+
+    this->state = POWER_OFF;
+}
+
+byte MHZ19Power::update()
+{
+    unsigned long uptime = getUptime();
+
+    switch (this->state)
+    {
+    case POWER_BOOT:
+        if (uptime < this->boot)
+            break;
+
+        /* checks the signature straight away */
+        this->state = POWER_WARMUP;
+        this->checkTimer = this->sensor->getClock() - this->check;
+
+        /* fall through */
+    case POWER_WARMUP:
+        /* ready regardless once the full preheat has passed */
+        if (uptime >= this->warmup)
+        {
+            this->warmupTime = uptime;
+            this->state = POWER_READY;
+            break;
+        }
+
+        if (this->sensor->getClock() - this->checkTimer < this->check)
+            break;
+
+        this->checkTimer = this->sensor->getClock();
+
+        if (!isWarming())
+        {
+            this->warmupTime = uptime;
+            this->state = POWER_READY;
+        }
+        break;
+
+    case POWER_READY:
+        this->sensor->maintain();
+        break;
+    }
+
+    return this->state;
+}
+
+int MHZ19Power::getCO2()
+{
+    if (this->state != POWER_READY)
+    {
+        this->sensor->errorCode = RESULT_NULL;
+        return 0;
+    }
+
+    int CO2 = this->sensor->getCO2();
+
+    if (this->sensor->errorCode == RESULT_OK)
+        this->samples++;
+
+    return CO2;
+}
+
+/*######################-Internal Functions-########################*/
+
+void MHZ19Power::setSupply(bool isON)
+{
+    digitalWrite(this->pin, isON == this->isActiveHigh ? HIGH : LOW);
+}
+
+bool MHZ19Power::isWarming()
+{
+    /* warm-up readings are not samples, so onSample() is not called for them */
+    MHZ19SampleCallback callback = this->sensor->getSampleCallback();
+    void *context = this->sensor->getSampleContext();
+
+    this->sensor->onSample(NULL);
+
+    /* limited (134) holds 410 during warm-up while unlimited (133) is abnormal */
+    int limited = this->sensor->getCO2(false);
+    int unlimited = 0;
+
+    if (this->sensor->errorCode == RESULT_OK)
+        unlimited = this->sensor->getCO2(true);
+
+    this->sensor->onSample(callback, context);
+
+    if (this->sensor->errorCode != RESULT_OK)
+        return true;
+
+    int difference = unlimited - limited;
+
+    return limited == 410 && (difference >= 10 || difference <= -10);
+}
@@ -0,0 +1,107 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#ifndef MHZ19_POWER_H
+#define MHZ19_POWER_H
+
+#include <Arduino.h>
+#include "MHZ19.h"
+
+#define MHZ19_POWER_BOOT 2000			// Time after power-on before the sensor answers (ms)
+#define MHZ19_POWER_WARMUP 180000UL		// Longest warm-up, ready regardless after this (ms, datasheet preheat)
+#define MHZ19_POWER_CHECK 5000			// Interval between warm-up signature checks (ms)
+
+/* enum alias for power states, see getState() */
+enum POWERSTATE
+{
+	POWER_OFF = 0,					// Supply switched off
+	POWER_BOOT = 1,					// Powered, sensor not yet answering
+	POWER_WARMUP = 2,				// Answering, readings still show the warm-up signature
+	POWER_READY = 3					// Readings are valid
+};
+
+/* Switches the sensor's supply through a GPIO (e.g. a MOSFET) and tracks time
+ * since power-on. Requests are held back until the sensor answers, and the
+ * warm-up signature (limited CO2 at 410 while unlimited differs) is checked
+ * so sampling starts as soon as it clears, rather than after the full preheat.
+ * Powered time is totalled so the energy cost of each valid sample is known.
+ */
+class MHZ19Power
+{
+  public:
+	/*#####################-Initiation Functions-#####################*/
+
+	/* pin drives the supply switch, isActiveHigh for an N-channel low side switch (HIGH = on).
+	 * Times are taken from the sensor's clock (see setClock()). The sensor is left OFF,
+	 * begin() the sensor while powered, or from a saved identity
+	 */
+	void begin(MHZ19 &sensor, byte pin, bool isActiveHigh = true);
+
+	/*########################-Set Functions-##########################*/
+
+	/* boot wait, longest warm-up and interval between signature checks (ms) */
+	void setTiming(unsigned long boot = MHZ19_POWER_BOOT, unsigned long warmup = MHZ19_POWER_WARMUP, unsigned long check = MHZ19_POWER_CHECK);
+
+	/*########################-Get Functions-##########################*/
+
+	/* returns POWERSTATE */
+	byte getState() { return this->state; };
+
+	/* returns true when readings are valid */
+	bool isReady() { return this->state == POWER_READY; };
+
+	/* ms since power-on, 0 while OFF */
+	unsigned long getUptime();
+
+	/* ms from power-on to ready in the last power cycle, 0 if not reached */
+	unsigned long getWarmupTime() { return this->warmupTime; };
+
+	/* total ms powered, including the current power cycle */
+	unsigned long getOnTime();
+
+	/* valid samples taken through getCO2() */
+	unsigned long getSamples() { return this->samples; };
+
+	/* powered ms per valid sample, 0 before the first */
+	unsigned long getOnTimePerSample();
+
+	/*######################-Utility Functions-########################*/
+
+	/* switches the supply on, from boot */
+	void on();
+
+	/* switches the supply off */
+	void off();
+
+	/* advances boot and warm-up, runs the sensor's maintenance once ready. Returns POWERSTATE */
+	byte update();
+
+	/* CO2 from the sensor once ready, otherwise 0 without communicating (sensor errorCode RESULT_NULL) */
+	int getCO2();
+
+  private:
+	/*###########################-Variables-##########################*/
+
+	MHZ19 *sensor = NULL;
+	byte pin = 0;
+	bool isActiveHigh = true;
+
+	unsigned long boot = MHZ19_POWER_BOOT;
+	unsigned long warmup = MHZ19_POWER_WARMUP;
+	unsigned long check = MHZ19_POWER_CHECK;
+
+	byte state = POWER_OFF;
+	unsigned long onTimer = 0;				// sensor clock time at power-on
+	unsigned long checkTimer = 0;			// sensor clock time at the last signature check
+	unsigned long warmupTime = 0;
+	unsigned long onTotal = 0;				// ms powered in completed cycles
+	unsigned long samples = 0;
+
+	/*######################-Internal Functions-########################*/
+
+	/* drives the supply pin */
+	void setSupply(bool isON);
+
+	/* returns true while readings show the warm-up signature, or the sensor does not answer */
+	bool isWarming();
+};
+#endif
@@ -0,0 +1,89 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#include "MHZ19RawModel.h"
+
+/*#####################-Initiation Functions-#####################*/
+
+void MHZ19RawModel::begin(const MHZ19RawPoint *table, byte length, bool isProgmem)
+{
+    this->table = table;
+    this->length = length;
+    this->isProgmem = isProgmem;
+}
+
+/*########################-Get Functions-##########################*/
+
+int MHZ19RawModel::toPPM(unsigned int raw)
+{
+    MHZ19RawPoint lo, hi;
+
+    if (!this->length)
+        return 0;
+
+    /* clamp to the ends of the table */
+    readPoint(0, lo);
+    if (raw <= lo.raw || this->length == 1)
+        return lo.ppm;
+
+    readPoint(this->length - 1, hi);
+    if (raw >= hi.raw)
+        return hi.ppm;
+
+    /* binary search for the segment with lo.raw <= raw < hi.raw */
+    byte first = 0;
+    byte last = this->length - 1;
+
+    while (last - first > 1)
+    {
+        byte mid = (first + last) / 2;
+
+        readPoint(mid, lo);
+
+        if (raw < lo.raw)
+            last = mid;
+        else
+            first = mid;
+    }
+
+    readPoint(first, lo);
+    readPoint(last, hi);
+
+    /* interpolate, rounding to nearest. A 16 bit offset times a 16 bit ppm step overflows
+     * a long, so the step is split into whole spans and a remainder: offset < span keeps
+     * both products within 32 unsigned bits, without 64 bit division on AVR
+     */
+    unsigned long span = hi.raw - lo.raw;
+    unsigned long offset = raw - lo.raw;
+    long step = (long)hi.ppm - lo.ppm;
+    unsigned long magnitude = step < 0 ? -step : step;
+
+    unsigned long moved = offset * (magnitude / span) + (offset * (magnitude % span) + span / 2) / span;
+
+    return step < 0 ? lo.ppm - (int)moved : lo.ppm + (int)moved;
+}
+
+int MHZ19RawModel::getCO2(MHZ19 &sensor, bool force)
+{
+    unsigned int raw = sensor.getCO2Raw(force);
+
+    if (force && sensor.errorCode != RESULT_OK)
+        return 0;
+
+    return toPPM(raw);
+}
+
+/*######################-Internal Functions-########################*/
+
+void MHZ19RawModel::readPoint(byte i, MHZ19RawPoint &point)
+{
+#if defined (__AVR__)
+    /* only AVR keeps flash in its own address space, elsewhere PROGMEM reads as RAM */
+    if (this->isProgmem)
+    {
+        point.raw = pgm_read_word((const uint16_t *)&this->table[i].raw);
+        point.ppm = (int)pgm_read_word((const uint16_t *)&this->table[i].ppm);
+    }
+    else
+#endif
+        point = this->table[i];
+}
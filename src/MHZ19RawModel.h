@@ -0,0 +1,48 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#ifndef MHZ19_RAW_MODEL_H
+#define MHZ19_RAW_MODEL_H
+
+#include <Arduino.h>
+#include "MHZ19.h"
+
+/* one knot of the raw (command 132) to ppm curve */
+struct MHZ19RawPoint
+{
+	unsigned int raw;			// raw value as returned by getCO2Raw()
+	int ppm;					// CO2 ppm reported at that raw value (command 133)
+};
+
+/* Converts raw readings to ppm through a piecewise-linear lookup table.
+ * Integer only, so no float library is pulled in. Tables can be generated
+ * from logged (raw, ppm) pairs with extras/Host/RawFit.
+ */
+class MHZ19RawModel
+{
+  public:
+	/*#####################-Initiation Functions-#####################*/
+
+	/* table must be sorted by ascending raw, set isProgmem when declared PROGMEM */
+	void begin(const MHZ19RawPoint *table, byte length, bool isProgmem = false);
+
+	/*########################-Get Functions-##########################*/
+
+	/* converts a raw value to ppm, clamped to the ends of the table */
+	int toPPM(unsigned int raw);
+
+	/* requests (or reuses, force = false) the raw value and converts it, returns 0 on error */
+	int getCO2(MHZ19 &sensor, bool force = true);
+
+  private:
+	/*###########################-Variables-##########################*/
+
+	const MHZ19RawPoint *table = NULL;
+	byte length = 0;
+	bool isProgmem = false;
+
+	/*######################-Internal Functions-########################*/
+
+	/* reads knot i from RAM or flash */
+	void readPoint(byte i, MHZ19RawPoint &point);
+};
+#endif
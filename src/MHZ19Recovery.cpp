@@ -0,0 +1,210 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#include "MHZ19Recovery.h"
+
+/*#####################-Initiation Functions-#####################*/
+
+void MHZ19Recovery::begin(MHZ19 &sensor)
+{
+    this->sensor = &sensor;
+    this->state = RECOVERY_IDLE;
+    this->isTriggered = false;
+    this->isVerifying = false;
+
+    clearCounts();
+}
+
+/*########################-Set Functions-##########################*/
+
+void MHZ19Recovery::setLimits(int minPPM, int maxPPM)
+{
+    this->minPPM = minPPM;
+    this->maxPPM = maxPPM;
+}
+
+void MHZ19Recovery::setThresholds(byte errors, byte outOfRange, byte stuck)
+{
+    this->errorLimit = errors;
+    this->rangeLimit = outOfRange;
+    this->stuckLimit = stuck;
+}
+
+void MHZ19Recovery::setAttempts(byte verifies, byte resets)
+{
+    this->verifyLimit = verifies ? verifies : 1;
+    this->resetLimit = resets ? resets : 1;
+}
+
+void MHZ19Recovery::setTiming(unsigned long warmup, unsigned long backoff)
+{
+    this->warmup = warmup;
+    this->backoff = backoff;
+}
+
+/*######################-Utility Functions-########################*/
+
+void MHZ19Recovery::sample(int ppm)
+{
+    if (this->sensor == NULL || isRecovering())
+        return;
+
+    byte code = this->sensor->errorCode;
+
+    /* communication failures, the filter is not a fault of the sensor */
+    if (code != RESULT_OK && code != RESULT_FILTER)
+    {
+        if (this->errorCount < 255)
+            this->errorCount++;
+    }
+    else if (code == RESULT_OK)
+    {
+        this->errorCount = 0;
+
+        if (ppm < this->minPPM || ppm > this->maxPPM)
+        {
+            if (this->rangeCount < 255)
+                this->rangeCount++;
+        }
+        else
+            this->rangeCount = 0;
+
+        if (ppm == this->lastPPM)
+        {
+            if (this->stuckCount < 255)
+                this->stuckCount++;
+        }
+        else
+            this->stuckCount = 0;
+
+        this->lastPPM = ppm;
+    }
+
+    if ((this->errorLimit && this->errorCount >= this->errorLimit)
+        || (this->rangeLimit && this->rangeCount >= this->rangeLimit)
+        || (this->stuckLimit && this->stuckCount >= this->stuckLimit))
+        trigger();
+}
+
+void MHZ19Recovery::trigger()
+{
+    if (this->state != RECOVERY_IDLE && this->state != RECOVERY_FAILED)
+        return;
+
+    this->resets = 0;
+    this->isTriggered = true;
+}
+
+void MHZ19Recovery::update()
+{
+    if (this->sensor == NULL)
+        return;
+
+    unsigned long now = this->sensor->getClock();
+
+    switch (this->state)
+    {
+    case RECOVERY_IDLE:
+    case RECOVERY_FAILED:
+        if (this->isTriggered)
+        {
+            this->isTriggered = false;
+            reset();
+        }
+        break;
+
+    case RECOVERY_WARMUP:
+        if (now - this->timer >= this->warmup)
+        {
+            this->attempt = 0;
+            this->wait = 0;
+            this->timer = now;
+            this->state = RECOVERY_VERIFY;
+        }
+        break;
+
+    case RECOVERY_VERIFY:
+#if MHZ19_ENABLE_ASYNC
+        /* a CO2 request is the verification, collected without waiting */
+        if (this->isVerifying)
+        {
+            if (!this->sensor->receive())
+                break;
+
+            this->isVerifying = false;
+            verified(this->sensor->errorCode == RESULT_OK);
+            break;
+        }
+#endif
+        if (now - this->timer < this->wait)
+            break;
+
+#if MHZ19_ENABLE_ASYNC
+        /* false while another request is awaited, tried again next update() */
+        if (!this->sensor->requestCO2())
+            break;
+
+        this->isVerifying = true;
+        report(RECOVERY_VERIFY, ++this->attempt);
+#else
+        report(RECOVERY_VERIFY, ++this->attempt);
+        verified(this->sensor->verify() == 0);
+#endif
+        break;
+    }
+}
+
+/*######################-Internal Functions-########################*/
+
+void MHZ19Recovery::reset()
+{
+    this->resets++;
+
+    report(RECOVERY_RESET, this->resets);
+    this->sensor->recoveryReset();
+
+    this->timer = this->sensor->getClock();
+    report(RECOVERY_WARMUP, this->resets);
+}
+
+void MHZ19Recovery::verified(bool isOK)
+{
+    if (isOK)
+    {
+        clearCounts();
+        report(RECOVERY_OK, this->attempt);
+        this->state = RECOVERY_IDLE;
+    }
+    else if (this->attempt >= this->verifyLimit)
+    {
+        if (this->resets < this->resetLimit)
+            reset();
+        else
+            report(RECOVERY_FAILED, this->resets);
+    }
+    else
+    {
+        /* wait twice as long before each further attempt */
+        this->wait = (this->attempt == 1) ? this->backoff : this->wait * 2;
+
+        if (this->wait > MHZ19_RECOVERY_BACKOFF_MAX)
+            this->wait = MHZ19_RECOVERY_BACKOFF_MAX;
+
+        this->timer = this->sensor->getClock();
+    }
+}
+
+void MHZ19Recovery::report(byte state, byte arg)
+{
+    this->state = state;
+
+    if (this->callback)
+        this->callback(state, arg);
+}
+
+void MHZ19Recovery::clearCounts()
+{
+    this->errorCount = 0;
+    this->rangeCount = 0;
+    this->stuckCount = 0;
+    this->lastPPM = -1;
+}
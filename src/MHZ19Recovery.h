@@ -0,0 +1,124 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#ifndef MHZ19_RECOVERY_H
+#define MHZ19_RECOVERY_H
+
+#include <Arduino.h>
+#include "MHZ19.h"
+
+#define MHZ19_RECOVERY_WARMUP 30000		// Wait after a reset before verifying (ms)
+#define MHZ19_RECOVERY_BACKOFF 1000		// First wait between verify attempts, doubled each attempt (ms)
+#define MHZ19_RECOVERY_BACKOFF_MAX 60000	// Longest wait between verify attempts (ms)
+
+/* enum alias for recovery states, passed to the progress callback */
+enum RECOVERYSTATE
+{
+	RECOVERY_IDLE = 0,				// Monitoring readings
+	RECOVERY_RESET = 1,				// Reset sent, arg: reset count
+	RECOVERY_WARMUP = 2,			// Waiting for the sensor to boot, arg: reset count
+	RECOVERY_VERIFY = 3,			// Verifying, arg: attempt
+	RECOVERY_OK = 4,				// Verified, back to monitoring, arg: attempt
+	RECOVERY_FAILED = 5				// Gave up, call trigger() to retry, arg: reset count
+};
+
+/* Watches readings for a stuck, out of range or unresponsive sensor, then
+ * resets it, waits out the warm-up and re-verifies with exponential backoff.
+ * Times come from the sensor's clock (see MHZ19::setClock()).
+ *
+ * Verification is a requestCO2() collected by receive() on later update()
+ * calls, so it never waits. The reset command goes through the blocking path
+ * though: update() waits up to TIMEOUT_PERIOD (500ms) once per reset. With
+ * MHZ19_ENABLE_ASYNC 0, each verify attempt is a blocking verify() of up to
+ * two round trips, 2 x TIMEOUT_PERIOD.
+ */
+class MHZ19Recovery
+{
+  public:
+	/* state is a RECOVERYSTATE, arg depends on the state (see above) */
+	typedef void (*Callback)(byte state, byte arg);
+
+	/*#####################-Initiation Functions-#####################*/
+
+	void begin(MHZ19 &sensor);
+
+	/*########################-Set Functions-##########################*/
+
+	/* readings outside min - max ppm count as out of range */
+	void setLimits(int minPPM = 390, int maxPPM = 2000);
+
+	/* consecutive errors, out of range or identical readings which trigger recovery, 0 disables */
+	void setThresholds(byte errors = 10, byte outOfRange = 20, byte stuck = 60);
+
+	/* verify attempts per reset, resets before giving up */
+	void setAttempts(byte verifies = 5, byte resets = 2);
+
+	/* warm-up after reset and first backoff (ms) */
+	void setTiming(unsigned long warmup = MHZ19_RECOVERY_WARMUP, unsigned long backoff = MHZ19_RECOVERY_BACKOFF);
+
+	/* called on every state change and verify attempt */
+	void onProgress(Callback callback) { this->callback = callback; };
+
+	/*########################-Get Functions-##########################*/
+
+	/* returns RECOVERYSTATE */
+	byte getState() { return this->state; };
+
+	/* returns true while the sensor should be left alone */
+	bool isRecovering() { return this->state != RECOVERY_IDLE; };
+
+	/*######################-Utility Functions-########################*/
+
+	/* feeds one reading, call after getCO2() (uses the sensor's errorCode) */
+	void sample(int ppm);
+
+	/* starts recovery now (also restarts after RECOVERY_FAILED) */
+	void trigger();
+
+	/* advances recovery, call often */
+	void update();
+
+  private:
+	/*###########################-Variables-##########################*/
+
+	MHZ19 *sensor = NULL;
+	Callback callback = NULL;
+
+	/* detection */
+	int minPPM = 390;
+	int maxPPM = 2000;
+	byte errorLimit = 10;
+	byte rangeLimit = 20;
+	byte stuckLimit = 60;
+	byte errorCount = 0;
+	byte rangeCount = 0;
+	byte stuckCount = 0;
+	int lastPPM = -1;
+	bool isTriggered = false;
+
+	/* recovery */
+	byte state = RECOVERY_IDLE;
+	byte verifyLimit = 5;
+	byte resetLimit = 2;
+	byte attempt = 0;
+	byte resets = 0;
+	unsigned long warmup = MHZ19_RECOVERY_WARMUP;
+	unsigned long backoff = MHZ19_RECOVERY_BACKOFF;
+	unsigned long wait = 0;
+	unsigned long timer = 0;				// sensor clock time of the reset or last verify attempt
+	bool isVerifying = false;				// verify request awaiting its reply
+
+	/*######################-Internal Functions-########################*/
+
+	/* sends the reset and starts the warm-up */
+	void reset();
+
+	/* ends a verify attempt, back to monitoring, retrying after the backoff, resetting or giving up */
+	void verified(bool isOK);
+
+	/* changes state and reports it */
+	void report(byte state, byte arg);
+
+	/* clears detection counters */
+	void clearCounts();
+};
+#endif
@@ -0,0 +1,261 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#include "MHZ19Safe.h"
+
+/*######################-Atomic Helpers-########################*/
+
+#if defined (__AVR__)
+#include <util/atomic.h>
+
+/* single core, disabling interrupts is enough (and 16 bit access is not atomic) */
+static unsigned int fetchIncrement(volatile unsigned int *value)
+{
+    unsigned int previous;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { previous = (*value)++; }
+    return previous;
+}
+
+static unsigned int loadAcquire(volatile unsigned int *value)
+{
+    unsigned int current;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { current = *value; }
+    return current;
+}
+
+static void storeRelease(volatile unsigned int *value, unsigned int next)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { *value = next; }
+}
+
+static bool tryAcquire(volatile byte *flag)
+{
+    bool isFree;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { isFree = !*flag; *flag = 1; }
+    return isFree;
+}
+
+static void release(volatile byte *flag)
+{
+    *flag = 0;
+}
+#else
+static unsigned int fetchIncrement(volatile unsigned int *value)
+{
+    return __atomic_fetch_add(value, 1, __ATOMIC_ACQ_REL);
+}
+
+static unsigned int loadAcquire(volatile unsigned int *value)
+{
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static void storeRelease(volatile unsigned int *value, unsigned int next)
+{
+    __atomic_store_n(value, next, __ATOMIC_RELEASE);
+}
+
+static bool tryAcquire(volatile byte *flag)
+{
+    return !__atomic_exchange_n(flag, 1, __ATOMIC_ACQUIRE);
+}
+
+static void release(volatile byte *flag)
+{
+    __atomic_store_n(flag, 0, __ATOMIC_RELEASE);
+}
+#endif
+
+/* lets the task holding the wire (or the slot) run */
+static void waitTurn()
+{
+#if defined (ESP32)
+    delay(1);
+#else
+    yield();
+#endif
+}
+
+/*#####################-Initiation Functions-#####################*/
+
+MHZ19Safe::MHZ19Safe(MHZ19 &sensor) : sensor(sensor)
+{
+    /* slot i is free for ticket i */
+    for (unsigned int i = 0; i < MHZ19_SAFE_QUEUE; i++)
+        this->queue[i].seq = i;
+}
+
+/*########################-Get Functions-##########################*/
+
+MHZ19Result<int> MHZ19Safe::getCO2(bool isunLimited)
+{
+    return convert<int>(submit(isunLimited ? OP_CO2UNLIM : OP_CO2LIM));
+}
+
+MHZ19Result<unsigned int> MHZ19Safe::getCO2Raw()
+{
+    return convert<unsigned int>(submit(OP_RAW));
+}
+
+MHZ19Result<int> MHZ19Safe::getTemperatureCenti()
+{
+    return convert<int>(submit(OP_TEMP));
+}
+
+MHZ19Result<byte> MHZ19Safe::getAccuracy()
+{
+    return convert<byte>(submit(OP_ACCURACY));
+}
+
+MHZ19Result<int> MHZ19Safe::getRange()
+{
+    return convert<int>(submit(OP_RANGE));
+}
+
+MHZ19Result<bool> MHZ19Safe::getABC()
+{
+    return convert<bool>(submit(OP_ABC));
+}
+
+MHZ19Result<int> MHZ19Safe::getBackgroundCO2()
+{
+    return convert<int>(submit(OP_BACKGROUND));
+}
+
+/*########################-Set Functions-##########################*/
+
+MHZ19Result<bool> MHZ19Safe::setRange(int range)
+{
+    return convert<bool>(submit(OP_SETRANGE, range));
+}
+
+MHZ19Result<bool> MHZ19Safe::autoCalibration(bool isON, byte ABCPeriod)
+{
+    return convert<bool>(submit(OP_AUTOCAL, isON, ABCPeriod));
+}
+
+MHZ19Result<bool> MHZ19Safe::calibrate()
+{
+    return convert<bool>(submit(OP_CALIBRATE));
+}
+
+/*######################-Utility Functions-########################*/
+
+MHZ19Result<bool> MHZ19Safe::verify()
+{
+    return convert<bool>(submit(OP_VERIFY));
+}
+
+/*######################-Internal Functions-########################*/
+
+MHZ19Result<long> MHZ19Safe::submit(Safe_Op op, int arg, byte arg2)
+{
+    unsigned int ticket = fetchIncrement(&this->tail);
+    request &slot = this->queue[ticket & (MHZ19_SAFE_QUEUE - 1)];
+
+    /* queue full, wait until the slot's previous owner has collected its result */
+    while (loadAcquire(&slot.seq) != ticket)
+        waitTurn();
+
+    slot.op = op;
+    slot.arg = arg;
+    slot.arg2 = arg2;
+
+    /* publish */
+    storeRelease(&slot.seq, ticket + 1);
+
+    /* whoever finds the wire free services everyone queued, in order */
+    while (loadAcquire(&slot.seq) != ticket + 2)
+    {
+        if (tryAcquire(&this->wireBusy))
+        {
+            service();
+            release(&this->wireBusy);
+        }
+        else
+            waitTurn();
+    }
+
+    MHZ19Result<long> result = slot.result;
+
+    /* hand the slot to the ticket one lap later */
+    storeRelease(&slot.seq, ticket + MHZ19_SAFE_QUEUE);
+
+    return result;
+}
+
+void MHZ19Safe::service()
+{
+    for (;;)
+    {
+        unsigned int ticket = this->head;
+        request &slot = this->queue[ticket & (MHZ19_SAFE_QUEUE - 1)];
+
+        /* stop at the first ticket not yet published */
+        if (loadAcquire(&slot.seq) != ticket + 1)
+            return;
+
+        execute(slot);
+
+        storeRelease(&slot.seq, ticket + 2);
+        this->head = ticket + 1;
+    }
+}
+
+void MHZ19Safe::execute(request &slot)
+{
+    long value = 0;
+
+    /* calls which are rejected without communicating leave RESULT_NULL */
+    this->sensor.errorCode = RESULT_NULL;
+
+    switch (slot.op)
+    {
+    case OP_CO2UNLIM:
+        value = this->sensor.getCO2(true);
+        break;
+    case OP_CO2LIM:
+        value = this->sensor.getCO2(false);
+        break;
+    case OP_RAW:
+        value = this->sensor.getCO2Raw();
+        break;
+    case OP_TEMP:
+        value = this->sensor.getTemperatureCenti();
+        break;
+    case OP_ACCURACY:
+        value = this->sensor.getAccuracy();
+        break;
+    case OP_RANGE:
+        value = this->sensor.getRange();
+        break;
+    case OP_ABC:
+        value = this->sensor.getABC();
+        break;
+    case OP_BACKGROUND:
+        value = this->sensor.getBackgroundCO2();
+        break;
+    case OP_SETRANGE:
+        this->sensor.setRange(slot.arg);
+        value = (this->sensor.errorCode == RESULT_OK);
+        break;
+    case OP_AUTOCAL:
+        this->sensor.autoCalibration(slot.arg, slot.arg2);
+        value = (this->sensor.errorCode == RESULT_OK);
+        break;
+    case OP_CALIBRATE:
+        this->sensor.calibrate();
+        value = (this->sensor.errorCode == RESULT_OK);
+        break;
+    case OP_VERIFY:
+        value = (this->sensor.verify() == 0);
+        if (!value && this->sensor.errorCode == RESULT_OK)
+            this->sensor.errorCode = RESULT_MATCH;      // both replies arrived but disagreed
+        break;
+    }
+
+    /* captured while still owning the wire, so nothing can overwrite them */
+    slot.result.value = value;
+    slot.result.error = this->sensor.errorCode;
+    slot.result.timeStamp = this->sensor.getClock();
+    slot.result.opcode = (slot.result.error == RESULT_NULL) ? 0 : this->sensor.getLastCommand();
+}
@@ -0,0 +1,115 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#ifndef MHZ19_SAFE_H
+#define MHZ19_SAFE_H
+
+#include <Arduino.h>
+#include "MHZ19.h"
+
+#define MHZ19_SAFE_QUEUE 8			// Requests which can be queued at once (power of 2)
+
+/* outcome of one request, owned by the caller */
+template <typename T>
+struct MHZ19Result
+{
+	T value;						// returned value, as the matching MHZ19 function
+	byte error;						// ERRORCODE of this request only
+	unsigned long timeStamp;		// sensor clock time (see MHZ19::setClock()) when the request completed
+	byte opcode;					// command byte sent, e.g. 0x85
+
+	bool ok() const { return error == RESULT_OK; }
+};
+
+/* Serialises access to one MHZ19 from several tasks. Calls are queued in a
+ * lock-free ring; whichever caller finds the wire free services the queue in
+ * order (including other callers' requests) and each caller receives its own
+ * result. Nothing shared needs to be read after a call returns.
+ *
+ * Only use the MHZ19 through this facade once it is shared.
+ */
+class MHZ19Safe
+{
+  public:
+	MHZ19Safe(MHZ19 &sensor);
+
+	/*########################-Get Functions-##########################*/
+
+	MHZ19Result<int> getCO2(bool isunLimited = true);
+	MHZ19Result<unsigned int> getCO2Raw();
+	MHZ19Result<int> getTemperatureCenti();
+	MHZ19Result<byte> getAccuracy();
+	MHZ19Result<int> getRange();
+	MHZ19Result<bool> getABC();
+	MHZ19Result<int> getBackgroundCO2();
+
+	/*########################-Set Functions-##########################*/
+
+	/* value is true if the request was acknowledged */
+	MHZ19Result<bool> setRange(int range = 2000);
+	MHZ19Result<bool> autoCalibration(bool isON = true, byte ABCPeriod = 24);
+	MHZ19Result<bool> calibrate();
+
+	/*######################-Utility Functions-########################*/
+
+	/* value is true if communication was verified */
+	MHZ19Result<bool> verify();
+
+  private:
+	/*###########################-Variables-##########################*/
+
+	/* alias for queued operations */
+	typedef enum SAFE_OP
+	{
+		OP_CO2UNLIM = 0,
+		OP_CO2LIM = 1,
+		OP_RAW = 2,
+		OP_TEMP = 3,
+		OP_ACCURACY = 4,
+		OP_RANGE = 5,
+		OP_ABC = 6,
+		OP_BACKGROUND = 7,
+		OP_SETRANGE = 8,
+		OP_AUTOCAL = 9,
+		OP_CALIBRATE = 10,
+		OP_VERIFY = 11
+	} Safe_Op;
+
+	/* a queue slot, seq tells whose turn it is:
+	 * ticket - free for ticket, ticket + 1 - queued, ticket + 2 - done
+	 */
+	struct request
+	{
+		volatile unsigned int seq;
+		byte op;
+		int arg;
+		byte arg2;
+		MHZ19Result<long> result;
+	};
+
+	MHZ19 &sensor;
+
+	request queue[MHZ19_SAFE_QUEUE];
+
+	volatile unsigned int tail = 0;			// next ticket to hand out
+	volatile unsigned int head = 0;			// next ticket to service (wire owner only)
+	volatile byte wireBusy = 0;				// set while a caller services the queue
+
+	/*######################-Internal Functions-########################*/
+
+	/* queues an operation and waits (servicing the queue if free) for its result */
+	MHZ19Result<long> submit(Safe_Op op, int arg = 0, byte arg2 = 0);
+
+	/* services queued requests in ticket order, returns once none are ready */
+	void service();
+
+	/* runs one operation against the sensor */
+	void execute(request &slot);
+
+	template <typename T>
+	static MHZ19Result<T> convert(const MHZ19Result<long> &in)
+	{
+		MHZ19Result<T> out = { (T)in.value, in.error, in.timeStamp, in.opcode };
+		return out;
+	}
+};
+#endif
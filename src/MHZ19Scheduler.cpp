@@ -0,0 +1,87 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#include "MHZ19Scheduler.h"
+
+/*########################-Set Functions-##########################*/
+
+void MHZ19Scheduler::set(byte job, unsigned long period, unsigned long now)
+{
+    if (job >= MHZ19_SCHEDULER_JOBS)
+        return;
+
+    if (!period)
+    {
+        stop(job);
+        return;
+    }
+
+    this->period[job] = period;
+    this->due[job] = now + period;
+    this->active |= (1 << job);
+
+    refresh(now);
+}
+
+void MHZ19Scheduler::stop(byte job)
+{
+    if (job >= MHZ19_SCHEDULER_JOBS)
+        return;
+
+    this->active &= ~(1 << job);
+
+    /* remaining jobs are all in the future relative to the cached earliest */
+    refresh(this->nextDue);
+}
+
+/*######################-Utility Functions-########################*/
+
+int8_t MHZ19Scheduler::next(unsigned long now)
+{
+    if (!isDue(now))
+        return -1;
+
+    for (byte i = 0; i < MHZ19_SCHEDULER_JOBS; i++)
+    {
+        if (!(this->active & (1 << i)) || (long)(now - this->due[i]) < 0)
+            continue;
+
+        /* keep the cadence, unless so far behind that a burst would follow */
+        this->due[i] += this->period[i];
+
+        if ((long)(now - this->due[i]) >= 0)
+            this->due[i] = now + this->period[i];
+
+        refresh(now);
+
+        return i;
+    }
+
+    refresh(now);
+
+    return -1;
+}
+
+/*######################-Internal Functions-########################*/
+
+void MHZ19Scheduler::refresh(unsigned long now)
+{
+    bool isFirst = true;
+    long earliest = 0;
+
+    for (byte i = 0; i < MHZ19_SCHEDULER_JOBS; i++)
+    {
+        if (!(this->active & (1 << i)))
+            continue;
+
+        /* distance from now, negative when overdue */
+        long distance = (long)(this->due[i] - now);
+
+        if (isFirst || distance < earliest)
+        {
+            earliest = distance;
+            isFirst = false;
+        }
+    }
+
+    this->nextDue = now + earliest;
+}
@@ -0,0 +1,54 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#ifndef MHZ19_SCHEDULER_H
+#define MHZ19_SCHEDULER_H
+
+#include <Arduino.h>
+
+#define MHZ19_SCHEDULER_JOBS 4			// Recurring jobs which can be scheduled at once
+
+/* Fixed slots of recurring jobs, keyed by a small job id. The earliest due
+ * time is cached, so checking for due work is a single compare. All time
+ * arithmetic is by difference, so millis() rollover is harmless.
+ */
+class MHZ19Scheduler
+{
+  public:
+	/*########################-Set Functions-##########################*/
+
+	/* (re)starts a job to fall due every period (ms) from now, period 0 stops it */
+	void set(byte job, unsigned long period, unsigned long now);
+
+	/* stops a job */
+	void stop(byte job);
+
+	/*########################-Get Functions-##########################*/
+
+	/* returns true if any job is due, a single compare */
+	bool isDue(unsigned long now) { return this->active && (long)(now - this->nextDue) >= 0; };
+
+	/* returns true if any job is scheduled */
+	bool isActive() { return this->active; };
+
+	/* returns when the earliest job falls due (only meaningful if isActive()) */
+	unsigned long getNextDue() { return this->nextDue; };
+
+	/*######################-Utility Functions-########################*/
+
+	/* returns the id of a due job and reschedules it, or -1 when none are due */
+	int8_t next(unsigned long now);
+
+  private:
+	/*###########################-Variables-##########################*/
+
+	unsigned long period[MHZ19_SCHEDULER_JOBS] = { 0 };
+	unsigned long due[MHZ19_SCHEDULER_JOBS] = { 0 };
+	byte active = 0;								// bit per scheduled job
+	unsigned long nextDue = 0;						// earliest due of active jobs
+
+	/*######################-Internal Functions-########################*/
+
+	/* updates nextDue from the active jobs */
+	void refresh(unsigned long now);
+};
+#endif
@@ -0,0 +1,245 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#include "MHZ19Series.h"
+
+/* payload bits after each prefix (0, 10, 110, 1110, 1111) */
+static const byte timeWidths[5] = { 0, 7, 9, 12, 32 };
+static const byte ppmWidths[5] = { 0, 4, 7, 10, 16 };
+
+static uint32_t zigzag(int32_t value)
+{
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value)
+{
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+/* prefix of ones, ended by a zero unless the longest */
+static byte prefixLength(byte prefix)
+{
+    return prefix < 4 ? prefix + 1 : 4;
+}
+
+static byte prefixBits(byte prefix)
+{
+    return prefix < 4 ? ((1 << prefix) - 1) << 1 : 0x0F;
+}
+
+/* smallest code whose payload holds value, values from 1 (0 has its own code) */
+static byte codeFor(uint32_t value, const byte widths[5])
+{
+    if (!value)
+        return 0;
+
+    for (byte code = 1; code < 4; code++)
+    {
+        if (value < ((uint32_t)1 << widths[code]))
+            return code;
+    }
+
+    return 4;
+}
+
+/*#####################-Initiation Functions-#####################*/
+
+void MHZ19Series::begin(byte *buffer, size_t size)
+{
+    this->buffer = buffer;
+    this->size = size;
+
+    clear();
+}
+
+/*######################-Utility Functions-########################*/
+
+bool MHZ19Series::append(unsigned long timestamp, int ppm)
+{
+    if (!this->buffer || this->count >= MHZ19_SERIES_MAX)
+    {
+        this->full = true;
+        return false;
+    }
+
+    uint32_t time = (uint32_t)timestamp;
+    uint32_t delta = time - this->lastTime;
+
+    /* both wrap, so the reader recovers them exactly */
+    uint32_t timeCode = zigzag((int32_t)(delta - this->lastDelta));
+    uint32_t ppmCode = zigzag((int32_t)ppm - this->lastPPM);
+
+    byte timePrefix = codeFor(timeCode, timeWidths);
+    byte ppmPrefix = codeFor(ppmCode, ppmWidths);
+
+    uint32_t length = this->count ? prefixLength(timePrefix) + timeWidths[timePrefix]
+                                    + prefixLength(ppmPrefix) + ppmWidths[ppmPrefix]
+                                  : 32 + 16;
+
+    if (this->bits + length > (uint32_t)this->size * 8)
+    {
+        this->full = true;
+        return false;
+    }
+
+    if (!this->count)
+    {
+        write(time, 32);
+        write((uint16_t)ppm, 16);
+        delta = 0;
+    }
+    else
+    {
+        write(prefixBits(timePrefix), prefixLength(timePrefix));
+        write(timeCode, timeWidths[timePrefix]);
+
+        write(prefixBits(ppmPrefix), prefixLength(ppmPrefix));
+
+        /* the longest ppm code holds the value itself */
+        write(ppmPrefix < 4 ? ppmCode : (uint16_t)ppm, ppmWidths[ppmPrefix]);
+    }
+
+    this->lastTime = time;
+    this->lastDelta = delta;
+    this->lastPPM = ppm;
+    this->count++;
+
+    this->buffer[0] = this->count & 0xFF;
+    this->buffer[1] = this->count >> 8;
+
+    return true;
+}
+
+void MHZ19Series::clear()
+{
+    if (this->buffer)
+        memset(this->buffer, 0, this->size);
+
+    this->bits = MHZ19_SERIES_HEADER * 8;
+    this->count = 0;
+    this->full = false;
+    this->lastTime = 0;
+    this->lastDelta = 0;
+    this->lastPPM = 0;
+}
+
+/*######################-Internal Functions-########################*/
+
+void MHZ19Series::write(uint32_t value, byte length)
+{
+    while (length)
+    {
+        byte space = 8 - (this->bits & 7);
+        byte take = length < space ? length : space;
+        byte chunk = (value >> (length - take)) & ((1 << take) - 1);
+
+        this->buffer[this->bits >> 3] |= chunk << (space - take);
+        this->bits += take;
+        length -= take;
+    }
+}
+
+/*#####################-Initiation Functions-#####################*/
+
+void MHZ19SeriesReader::begin(const byte *buffer, size_t size)
+{
+    this->buffer = buffer;
+    this->size = size;
+    this->bits = MHZ19_SERIES_HEADER * 8;
+    this->index = 0;
+    this->lastTime = 0;
+    this->lastDelta = 0;
+    this->lastPPM = 0;
+
+    this->count = size < MHZ19_SERIES_HEADER ? 0 : buffer[0] | (buffer[1] << 8);
+}
+
+/*######################-Utility Functions-########################*/
+
+bool MHZ19SeriesReader::next(unsigned long &timestamp, int &ppm)
+{
+    if (this->index >= this->count)
+        return false;
+
+    uint32_t time, value;
+    byte timePrefix = 0, ppmPrefix = 0;
+
+    /* a stream ending early was truncated, no samples are read after it */
+    if (!this->index)
+    {
+        if (!read(32, time) || !read(16, value))
+        {
+            this->index = this->count;
+            return false;
+        }
+
+        this->lastTime = time;
+        this->lastPPM = (int16_t)value;
+    }
+    else
+    {
+        if (!readPrefix(timePrefix) || !read(timeWidths[timePrefix], time)
+            || !readPrefix(ppmPrefix) || !read(ppmWidths[ppmPrefix], value))
+        {
+            this->index = this->count;
+            return false;
+        }
+
+        uint32_t delta = this->lastDelta + (uint32_t)unzigzag(time);
+
+        this->lastPPM = ppmPrefix < 4 ? this->lastPPM + unzigzag(value) : (int16_t)value;
+        this->lastTime += delta;
+        this->lastDelta = delta;
+    }
+
+    this->index++;
+
+    timestamp = this->lastTime;
+    ppm = this->lastPPM;
+
+    return true;
+}
+
+/*######################-Internal Functions-########################*/
+
+bool MHZ19SeriesReader::read(byte length, uint32_t &value)
+{
+    value = 0;
+
+    /* checked whole, so the value is never shifted by all of its 32 bits */
+    if (length > 32 || this->bits + length > (uint32_t)this->size * 8)
+        return false;
+
+    while (length)
+    {
+        byte space = 8 - (this->bits & 7);
+        byte take = length < space ? length : space;
+        byte chunk = (this->buffer[this->bits >> 3] >> (space - take)) & ((1 << take) - 1);
+
+        value = (value << take) | chunk;
+        this->bits += take;
+        length -= take;
+    }
+
+    return true;
+}
+
+bool MHZ19SeriesReader::readPrefix(byte &prefix)
+{
+    uint32_t bit;
+
+    prefix = 0;
+
+    while (prefix < 4)
+    {
+        if (!read(1, bit))
+            return false;
+
+        if (!bit)
+            break;
+
+        prefix++;
+    }
+
+    return true;
+}
@@ -0,0 +1,117 @@
+/*   Version: 1.5.3  |  License: LGPLv3  |  Author: JDWifWaf@gmail.com   */
+
+#ifndef MHZ19_SERIES_H
+#define MHZ19_SERIES_H
+
+#include <Arduino.h>
+
+#define MHZ19_SERIES_HEADER 2			// Sample count held at the start of the buffer (bytes)
+#define MHZ19_SERIES_MAX 65535			// Samples one buffer can count
+
+/* Compresses (timestamp, ppm) samples into a fixed buffer, in the manner of
+ * Facebook's Gorilla. Timestamps are stored as the change in interval
+ * (delta-of-delta), a single bit when samples are evenly spaced, and ppm as
+ * the zig-zag change from the previous sample in a variable length field,
+ * a single bit when unchanged. Evenly spaced samples in a steady room take
+ * about a byte each. Appending is constant time and no heap is used.
+ *
+ * Layout: sample count (2 bytes, little endian), first timestamp (32 bits)
+ * and ppm (16 bits), then per sample a timestamp code and a ppm code, each a
+ * prefix of 0, 10, 110, 1110 or 1111 and its payload, bits written MSB first.
+ *
+ *   timestamp delta-of-delta (zig-zag)  0 | 10 + 7 | 110 + 9 | 1110 + 12 | 1111 + 32 bits
+ *   ppm change (zig-zag)                0 | 10 + 4 | 110 + 7 | 1110 + 10 | 1111 + 16 bits (ppm itself)
+ */
+class MHZ19Series
+{
+  public:
+	/*#####################-Initiation Functions-#####################*/
+
+	/* buffer is cleared and filled by append(), size in bytes */
+	void begin(byte *buffer, size_t size);
+
+	/*########################-Get Functions-##########################*/
+
+	/* samples held */
+	unsigned int getCount() { return this->count; };
+
+	/* bytes used, to be sent or stored */
+	size_t getSize() { return (this->bits + 7) / 8; };
+
+	const byte *getBuffer() { return this->buffer; };
+
+	/* true once a sample could not be appended */
+	bool isFull() { return this->full; };
+
+	/*######################-Utility Functions-########################*/
+
+	/* appends a sample, timestamps in any unit (coarser compresses better, e.g. seconds).
+	 * Returns false when it does not fit, the buffer is unchanged
+	 */
+	bool append(unsigned long timestamp, int ppm);
+
+	/* empties the buffer */
+	void clear();
+
+  private:
+	/*###########################-Variables-##########################*/
+
+	byte *buffer = NULL;
+	size_t size = 0;
+	uint32_t bits = 0;					// bits written, including the header
+	unsigned int count = 0;
+	bool full = false;
+
+	uint32_t lastTime = 0;
+	uint32_t lastDelta = 0;
+	int lastPPM = 0;
+
+	/*######################-Internal Functions-########################*/
+
+	/* writes the low length bits of value, MSB first */
+	void write(uint32_t value, byte length);
+};
+
+/* Reads samples back from a MHZ19Series buffer, on the node or on a host
+ * (see extras/Host/Series).
+ */
+class MHZ19SeriesReader
+{
+  public:
+	/*#####################-Initiation Functions-#####################*/
+
+	/* buffer as given by MHZ19Series::getBuffer(), size in bytes */
+	void begin(const byte *buffer, size_t size);
+
+	/*########################-Get Functions-##########################*/
+
+	/* samples in the buffer */
+	unsigned int getCount() { return this->count; };
+
+	/*######################-Utility Functions-########################*/
+
+	/* reads the next sample, returns false after the last or on a truncated buffer */
+	bool next(unsigned long &timestamp, int &ppm);
+
+  private:
+	/*###########################-Variables-##########################*/
+
+	const byte *buffer = NULL;
+	size_t size = 0;
+	uint32_t bits = 0;					// bits read, including the header
+	unsigned int count = 0;
+	unsigned int index = 0;
+
+	uint32_t lastTime = 0;
+	uint32_t lastDelta = 0;
+	int lastPPM = 0;
+
+	/*######################-Internal Functions-########################*/
+
+	/* reads length (up to 32) bits to value, MSB first. False, reading nothing, past the end */
+	bool read(byte length, uint32_t &value);
+
+	/* reads a 0 / 10 / 110 / 1110 / 1111 prefix as 0 - 4, false past the end */
+	bool readPrefix(byte &prefix);
+};
+#endif